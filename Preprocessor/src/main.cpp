@@ -7,8 +7,9 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
-#include <regex>
 #include <map>
+#include <set>
+#include "char_class.hpp"
 namespace fs = std::filesystem;
 
 // Function to read the entire content of a file into a string
@@ -23,6 +24,46 @@ std::string readFileContent(const std::string& filepath) {
     return buffer.str();
 }
 
+// Replaces every identifier that names a macro, using the compiler's character classes
+// so identifier boundaries match what nytro-c will see. Replacement text is rescanned,
+// a macro is never expanded inside its own expansion.
+std::string expandMacros(const std::string& text, const std::map<std::string, std::string>& defined_macros, std::set<std::string>& expanding) {
+    std::string result;
+    result.reserve(text.size());
+    size_t pos = 0;
+    while (pos < text.size()) {
+        if (!lex::isIdentifierChar(text[pos])) {
+            result += text[pos++];
+            continue;
+        }
+        size_t start = pos;
+        while (pos < text.size() && lex::isIdentifierChar(text[pos])) pos++;
+        std::string word = text.substr(start, pos - start);
+
+        auto it = defined_macros.find(word);
+        if (it == defined_macros.end() || expanding.count(word)) {
+            result += word;
+            continue;
+        }
+        expanding.insert(word);
+        result += expandMacros(it->second, defined_macros, expanding);
+        expanding.erase(word);
+    }
+    return result;
+}
+
+// Writes `#line N "file"` so nytro-c can map the output back to the original files.
+// Needed at the top of every file and wherever lines were dropped or an include ended.
+// A '"' or a backslash in the path gets a backslash in front, the lexer takes it off again.
+void writeLineMarker(std::ostream& output_stream, int line_number, const std::string& filepath) {
+    output_stream << "#line " << line_number << " \"";
+    for (char c : filepath) {
+        if (c == '"' || c == '\\') output_stream << '\\';
+        output_stream << c;
+    }
+    output_stream << "\"\n";
+}
+
 void processFile(const std::string& input_filepath, std::ostream& output_stream, std::map<std::string, std::string>& defined_macros) {
     std::ifstream input_file(input_filepath);
     if (!input_file.is_open()) {
@@ -31,8 +72,11 @@ void processFile(const std::string& input_filepath, std::ostream& output_stream,
     }
 
     bool skipping = false;
+    bool need_marker = true;
+    int line_number = 0;
     std::string line;
     while (std::getline(input_file, line)) {
+        line_number++;
         std::string trimmed_line = line;
         size_t first = trimmed_line.find_first_not_of(" \t");
         if (first != std::string::npos) {
@@ -46,13 +90,16 @@ void processFile(const std::string& input_filepath, std::ostream& output_stream,
             if (defined_macros.count(macro_name)) {
                 skipping = true;
             }
+            need_marker = true;
             continue;
         } else if (trimmed_line.rfind("#endif", 0) == 0) {
             skipping = false;
+            need_marker = true;
             continue;
         }
 
         if (skipping) {
+            need_marker = true;
             continue;
         }
 
@@ -66,6 +113,7 @@ void processFile(const std::string& input_filepath, std::ostream& output_stream,
                 macro_value = macro_value.substr(val_first);
             }
             defined_macros[macro_name] = macro_value;
+            need_marker = true;
             continue;
         }
 
@@ -85,18 +133,19 @@ void processFile(const std::string& input_filepath, std::ostream& output_stream,
                     included_file_path = current_file_path.parent_path() / include_path;
                 }
                 processFile(included_file_path.string(), output_stream, defined_macros);
+                need_marker = true;
             } else {
                 std::cerr << "Preprocessor Error: Invalid include directive: " << line << std::endl;
+                if (need_marker) writeLineMarker(output_stream, line_number, input_filepath);
+                need_marker = false;
                 output_stream << line << std::endl;
             }
         } else {
             // Macro replacement
-            for (const auto& pair : defined_macros) {
-                 if (!pair.first.empty()) {
-                    std::regex re("\\b" + pair.first + "\\b");
-                    line = std::regex_replace(line, re, pair.second);
-                }
-            }
+            std::set<std::string> expanding;
+            line = expandMacros(line, defined_macros, expanding);
+            if (need_marker) writeLineMarker(output_stream, line_number, input_filepath);
+            need_marker = false;
             output_stream << line << std::endl;
         }
     }
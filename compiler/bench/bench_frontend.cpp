@@ -0,0 +1,264 @@
+// Front-end throughput benchmark.
+// Generates a synthetic Nytrogen program of a given size and shape, then times tokenize()
+// and Parser::parse() on it in-process and reports MB/s, tokens/s, nodes/s and allocation
+// counts per phase, plus the time to load the same AST back from the binary AST cache. Usage:
+//   nytro-bench-frontend [--size-mb N] [--shape functions|nesting|expressions|strings|all]
+//                        [--depth N] [--terms N] [--iterations N] [--lex-threads N] [--parse-threads N]
+//                        [--dump file]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "ast.hpp"
+#include "ast_cache.hpp"
+
+// Allocation accounting, every operator new in the process goes through here
+namespace {
+struct AllocStats {
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> bytes{0};
+    std::atomic<size_t> live{0};
+    std::atomic<size_t> peak{0};
+};
+AllocStats g_alloc;
+
+constexpr size_t ALLOC_HEADER = 16; // Keeps the returned pointer 16-byte aligned
+
+void* countedAlloc(size_t size) {
+    void* block = std::malloc(size + ALLOC_HEADER);
+    if (!block) throw std::bad_alloc();
+    *static_cast<size_t*>(block) = size;
+    g_alloc.count++;
+    g_alloc.bytes += size;
+    size_t live = g_alloc.live += size;
+    size_t peak = g_alloc.peak.load();
+    while (live > peak && !g_alloc.peak.compare_exchange_weak(peak, live)) {}
+    return static_cast<char*>(block) + ALLOC_HEADER;
+}
+
+void countedFree(void* ptr) {
+    if (!ptr) return;
+    void* block = static_cast<char*>(ptr) - ALLOC_HEADER;
+    g_alloc.live -= *static_cast<size_t*>(block);
+    std::free(block);
+}
+} // namespace
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { countedFree(ptr); }
+
+namespace {
+
+struct Options {
+    double size_mb = 4.0;
+    std::string shape = "all";
+    int depth = 32;      // Nesting shape: blocks per function
+    int terms = 64;      // Expressions shape: operands per expression
+    int iterations = 5;  // Best time wins
+    unsigned lex_threads = 1;
+    unsigned parse_threads = 1;
+    std::string dump_path;
+};
+
+// Program generators, one function per call
+void genFunction(std::string& out, int i) {
+    std::string n = std::to_string(i);
+    out += "int f_" + n + "(int a, int b) {\n";
+    out += "    int x = a + b * " + n + ";\n";
+    out += "    if (x > 10) {\n        return x - 1;\n    }\n";
+    out += "    return x;\n}\n\n";
+}
+
+void genNesting(std::string& out, int i, int depth) {
+    out += "int n_" + std::to_string(i) + "(int a) {\n    int x = 0;\n";
+    std::string indent = "    ";
+    for (int d = 0; d < depth; ++d) {
+        out += indent + (d % 2 ? "while (x < a) {\n" : "if (a > " + std::to_string(d) + ") {\n");
+        indent += "    ";
+    }
+    out += indent + "x = x + 1;\n";
+    for (int d = depth - 1; d >= 0; --d) {
+        indent.resize(indent.size() - 4);
+        out += indent + "}\n";
+    }
+    out += "    return x;\n}\n\n";
+}
+
+void genExpression(std::string& out, int i, int terms) {
+    static const char* ops[] = {" + ", " - ", " * ", " / "};
+    out += "int e_" + std::to_string(i) + "(int a, int b) {\n    return ";
+    for (int t = 0; t < terms; ++t) {
+        if (t) out += ops[t % 4];
+        if (t % 3 == 0) out += "(a" + std::string(ops[(t + 1) % 4]) + std::to_string(t + 1) + ")";
+        else out += t % 3 == 1 ? "b" : std::to_string(t + 1);
+    }
+    out += ";\n}\n\n";
+}
+
+void genStrings(std::string& out, int i) {
+    std::string n = std::to_string(i);
+    out += "void s_" + n + "() {\n";
+    for (int k = 0; k < 8; ++k) {
+        out += "    print(\"string literal " + n + "." + std::to_string(k) + " with a bit of text in it\");\n";
+    }
+    out += "}\n\n";
+}
+
+std::string generateProgram(const Options& options) {
+    size_t target = static_cast<size_t>(options.size_mb * 1024 * 1024);
+    std::string out;
+    out.reserve(target + 4096);
+    for (int i = 0; out.size() < target; ++i) {
+        int pick = options.shape == "functions" ? 0 :
+                   options.shape == "nesting" ? 1 :
+                   options.shape == "expressions" ? 2 :
+                   options.shape == "strings" ? 3 : i % 4;
+        switch (pick) {
+            case 0: genFunction(out, i); break;
+            case 1: genNesting(out, i, options.depth); break;
+            case 2: genExpression(out, i, options.terms); break;
+            default: genStrings(out, i); break;
+        }
+    }
+    out += "int main() {\n    return 0;\n}\n";
+    return out;
+}
+
+size_t countNodes(ProgramNode& program) {
+    size_t count = 0;
+    walkPreOrder(&program, [&count](ASTNode*) { count++; });
+    return count;
+}
+
+struct PhaseResult {
+    double seconds = 1e100; // Best of all iterations
+    size_t allocs = 0;
+    size_t alloc_bytes = 0;
+    size_t peak_bytes = 0;  // Peak live heap above what was live when the phase started
+};
+
+// Runs body(setup()) options.iterations times, keeps the best time and the allocation figures.
+// Only body is timed; whatever it returns is destroyed after the clock stops.
+template <typename Setup, typename Body>
+PhaseResult measure(const Options& options, Setup setup, Body body) {
+    PhaseResult result;
+    for (int i = 0; i < options.iterations; ++i) {
+        auto state = setup();
+        size_t count = g_alloc.count, bytes = g_alloc.bytes, base = g_alloc.live;
+        g_alloc.peak = base;
+        auto start = std::chrono::steady_clock::now();
+        auto keep = body(*state);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.seconds = std::min(result.seconds, seconds);
+        result.allocs = g_alloc.count - count;
+        result.alloc_bytes = g_alloc.bytes - bytes;
+        result.peak_bytes = g_alloc.peak - base;
+    }
+    return result;
+}
+
+void report(const char* phase, const PhaseResult& r, size_t bytes, size_t tokens, size_t nodes) {
+    const double mb = 1024.0 * 1024.0;
+    std::printf("%-22s %9.2f %9.1f %12.0f %12.0f %10zu %10.1f %9.1f\n", phase, r.seconds * 1e3,
+                bytes / mb / r.seconds, tokens / r.seconds, nodes ? nodes / r.seconds : 0.0,
+                r.allocs, r.alloc_bytes / mb, r.peak_bytes / mb);
+}
+
+bool parseArgs(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--size-mb") options.size_mb = std::atof(value.c_str());
+        else if (arg == "--shape") options.shape = value;
+        else if (arg == "--depth") options.depth = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--terms") options.terms = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--iterations") options.iterations = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--lex-threads") options.lex_threads = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--parse-threads") options.parse_threads = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--dump") options.dump_path = value;
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    static const char* shapes[] = {"functions", "nesting", "expressions", "strings", "all"};
+    if (std::find(std::begin(shapes), std::end(shapes), options.shape) == std::end(shapes)) {
+        std::cerr << "Unknown shape " << options.shape << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) return 2;
+
+    std::string source = generateProgram(options);
+    if (!options.dump_path.empty()) std::ofstream(options.dump_path) << source;
+
+    // One untimed pass for the counts (and to warm the interner like a real compile would)
+    size_t token_count = tokenize(source, options.lex_threads).size();
+    size_t node_count = 0;
+    {
+        Parser parser{tokenize(source, options.lex_threads), options.parse_threads};
+        node_count = countNodes(*parser.parse());
+    }
+
+    std::printf("shape=%s size=%.2f MB tokens=%zu nodes=%zu iterations=%d lex-threads=%u parse-threads=%u\n\n",
+                options.shape.c_str(), source.size() / (1024.0 * 1024.0), token_count, node_count,
+                options.iterations, options.lex_threads, options.parse_threads);
+    std::printf("%-22s %9s %9s %12s %12s %10s %10s %9s\n", "phase", "ms", "MB/s", "tokens/s", "nodes/s",
+                "allocs", "alloc MB", "peak MB");
+
+    auto noSetup = [] { return std::make_unique<int>(0); };
+
+    PhaseResult lex = measure(options, noSetup, [&](int) {
+        return tokenize(source, options.lex_threads);
+    });
+    report("lex", lex, source.size(), token_count, 0);
+
+    // Parse on its own, from tokens lexed outside the timed region
+    PhaseResult parse = measure(options,
+        [&] { return std::make_unique<Parser>(tokenize(source, options.lex_threads), options.parse_threads); },
+        [](Parser& parser) { return parser.parse(); });
+    report("parse", parse, source.size(), token_count, node_count);
+
+    PhaseResult streaming = measure(options,
+        [&] { return std::make_unique<Parser>(Lexer(source)); },
+        [](Parser& parser) { return parser.parse(); });
+    report("lex+parse (streaming)", streaming, source.size(), token_count, node_count);
+
+    // Cache file written once outside the timed region, in the working directory
+    const std::string cache_path = "nytro-bench-frontend.astc";
+    uint64_t source_hash = hashSource(source);
+    if (!writeASTCache(cache_path, *Parser(Lexer(source)).parse(), source_hash)) {
+        std::cerr << "Could not write " << cache_path << std::endl;
+        return 1;
+    }
+    PhaseResult cached = measure(options, noSetup, [&](int) {
+        return loadASTCache(cache_path, hashSource(source)); // Hashing is part of every cache hit
+    });
+    std::remove(cache_path.c_str());
+    report("load AST cache", cached, source.size(), token_count, node_count);
+    return 0;
+}
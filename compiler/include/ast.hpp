@@ -2,65 +2,93 @@
 #define AST_HPP
 
 #include "utils.hpp"
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <memory>
 #include <iostream>
 #include <fstream>
+#include <type_traits>
+#include <stdexcept>
 #include "lexer.hpp"
+#include "ast_arena.hpp"
+#include "types.hpp"
+#include "source_manager.hpp"
 
 struct Symbol; // Forward declaration for Symbol
 
-// Forward declarations for type nodes
-struct TypeNode;
-struct PointerTypeNode;
-struct ArrayTypeNode;
+struct ASTNode;
+
+// THE NODE LIST: X(NodeType, NodeClass, KindName)
+// Generates the NodeType enum, nodeTypeName() and the ASTVisitor dispatch. The order is
+// the numbering, so reordering it changes the AST cache and --emit-ast=bin formats.
+#define AST_NODE_LIST(X) \
+    X(PROGRAM, ProgramNode, "PROGRAM") \
+    X(INTEGER_LITERAL_EXPRESSION, IntegerLiteralExpressionNode, "INTEGER_LITERAL") \
+    X(RETURN_STATEMENT, ReturnStatementNode, "RETURN_STATEMENT") \
+    X(VARIABLE_DECLARATION, VariableDeclarationNode, "VARIABLE_DECLARATION") \
+    X(VARIABLE_ASSIGNMENT, VariableAssignmentNode, "VARIABLE_ASSIGNMENT") \
+    X(VARIABLE_REFERENCE, VariableReferenceNode, "VARIABLE_REFERENCE") \
+    X(FUNCTION_DEFINITION, FunctionDefinitionNode, "FUNCTION_DEFINITION") \
+    X(BINARY_OPERATION_EXPRESSION, BinaryOperationExpressionNode, "BINARY_OPERATION") \
+    X(PRINT_STATEMENT, PrintStatementNode, "PRINT_STATEMENT") \
+    X(STRING_LITERAL_EXPRESSION, StringLiteralExpressionNode, "STRING_LITERAL") \
+    X(IF_STATEMENT, IfStatementNode, "IF_STATEMENT") \
+    X(FUNCTION_CALL, FunctionCallNode, "FUNCTION_CALL") \
+    X(WHILE_STATEMENT, WhileStatementNode, "WHILE_STATEMENT") \
+    X(BOOLEAN_LITERAL_EXPRESSION, BooleanLiteralExpressionNode, "BOOLEAN_LITERAL") \
+    X(CHARACTER_LITERAL_EXPRESSION, CharacterLiteralExpressionNode, "CHARACTER_LITERAL") \
+    X(FOR_STATEMENT, ForStatementNode, "FOR_STATEMENT") \
+    X(UNARY_OP_EXPRESSION, UnaryOpExpressionNode, "UNARY_OPERATION") \
+    X(ARRAY_ACCESS_EXPRESSION, ArrayAccessNode, "ARRAY_ACCESS") \
+    X(STRUCT_DEFINITION, StructDefinitionNode, "STRUCT_DEFINITION") \
+    X(MEMBER_ACCESS_EXPRESSION, MemberAccessNode, "MEMBER_ACCESS") \
+    X(ASM_STATEMENT, AsmStatementNode, "ASM_STATEMENT") \
+    X(ENUM_STATEMENT, EnumStatementNode, "ENUM_STATEMENT") \
+    X(CONSTANT_DECLARATION, ConstantDeclarationNode, "CONSTANT_DECLARATION") \
+    X(FLOAT_LITERAL_EXPRESSION, FloatLiteralExpressionNode, "FLOAT_LITERAL") \
+    X(DOUBLE_LITERAL_EXPRESSION, DoubleLiteralExpressionNode, "DOUBLE_LITERAL") \
+    X(SWITCH_STATEMENT, SwitchStatementNode, "SWITCH_STATEMENT") \
+    X(NAMESPACE_DEFINITION, NamespaceDefinition, "NAMESPACE_DEFINITION") \
+    X(SCOPE_RESOLUTION, ScopeResolutionNode, "SCOPE_RESOLUTION")
+
+// Callback handed to ASTNode::for_each_child. A non-owning reference to the caller's
+// lambda (a pointer and a trampoline), so unlike std::function it never allocates.
+// Null children are skipped here, visitors only ever see real nodes.
+class ChildVisitor {
+public:
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, ChildVisitor>>>
+    ChildVisitor(F&& f)
+        : context(const_cast<void*>(static_cast<const void*>(&f))),
+          call([](void* context, ASTNode* node) { (*static_cast<std::remove_reference_t<F>*>(context))(node); }) {}
+
+    void operator()(ASTNode* node) const { if (node) call(context, node); }
+    template <typename T, typename D>
+    void operator()(const std::unique_ptr<T, D>& node) const { (*this)(node.get()); }
+
+private:
+    void* context;
+    void (*call)(void*, ASTNode*);
+};
 
 // Base node class for all AST elements
 struct ASTNode {
-    enum class NodeType {
-        PROGRAM = 0,
-        INTEGER_LITERAL_EXPRESSION = 1,
-        RETURN_STATEMENT = 2,
-        VARIABLE_DECLARATION = 3,
-        VARIABLE_ASSIGNMENT = 4,
-        VARIABLE_REFERENCE = 5,
-        FUNCTION_DEFINITION = 6,
-        BINARY_OPERATION_EXPRESSION = 7,
-        PRINT_STATEMENT = 8,
-        STRING_LITERAL_EXPRESSION = 9,
-        IF_STATEMENT = 10,
-        ELSE_STATEMENT = 11,
-        FUNCTION_CALL = 12,
-        WHILE_STATEMENT = 13,
-        BOOLEAN_LITERAL_EXPRESSION = 14,
-        CHARACTER_LITERAL_EXPRESSION = 15,
-        FOR_STATEMENT = 16,
-        UNARY_OP_EXPRESSION = 17,
-        ARRAY_ACCESS_EXPRESSION = 18,
-        STRUCT_DEFINITION = 19,
-        MEMBER_ACCESS_EXPRESSION = 20,
-	    ASM_STATEMENT = 21,
-	    CONSTANT_LITERAL_EXPRESSION = 22,
-	    ENUM_STATEMENT = 23,
-	    CONSTANT_DECLARATION = 24,
-	    FLOAT_LITERAL_EXPRESSION = 25,
-	    DOUBLE_LITERAL_EXPRESSION = 26,
-	    SWITCH_STATEMENT = 27,
-        NAMESPACE_DEFINITION = 28,
-        SCOPE_RESOLUTION = 29,
+    enum class NodeType : uint8_t {
+#define AS_NODE_TYPE(type, node_class, name) type,
+        AST_NODE_LIST(AS_NODE_TYPE)
+#undef AS_NODE_TYPE
     };
 
     NodeType node_type;
+    SourceLoc loc; // Where the node starts, SourceManager turns it into file/line/column
 
     // resolved_type
-    std::shared_ptr<TypeNode> resolved_type;	
+    const TypeNode* resolved_type = nullptr;
 
-    int line;    // Source line position
-    int column;  // Source column position
+    ASTNode* arena_prev = nullptr; // Previous node from the same arena, so it can destroy them without recursing
 
-    ASTNode(NodeType type, int line = -1, int column = -1)
-        : node_type(type), line(line), column(column) {}
+    ASTNode(NodeType type, SourceLoc loc = NO_LOC)
+        : node_type(type), loc(loc) {}
 
     virtual ~ASTNode() = default;
 
@@ -68,29 +96,29 @@ struct ASTNode {
         return "ASTNode"; 
     }
 
-    virtual std::vector<ASTNode*> get_children() const {
-        return {}; // Base node has no children
+    // Calls visit on every direct child, in source order
+    virtual void for_each_child(ChildVisitor visit) const {
+        (void)visit; // Base node has no children
     }
 
     virtual std::string get_value() const { return ""; }
 
     virtual bool is_constant() const { return false; }
 
-    void dump_to_stream(std::ostream& out, int indent) { // TODO: make it output to .json
+    // Indented text for humans, tools should use --emit-ast (ast_export.hpp)
+    void dump_to_stream(std::ostream& out, int indent) {
         std::string space(indent * 2, ' ');
         out << space << " " << this->type_name();
 
         std::string val = this->get_value();
         if (!val.empty()) out << " (" << val << ")";
-        out << std::endl;
+        out << '\n';
 
-        for (auto* child : get_children()) {
-            if (child) child->dump_to_stream(out, indent + 1);
-        }
+        for_each_child([&out, indent](ASTNode* child) { child->dump_to_stream(out, indent + 1); });
     }
 
-    void dump() {
-        std::ofstream ast_file("ast.txt", std::ios::trunc);
+    void dump(const std::string& path = "ast.txt") {
+        std::ofstream ast_file(path, std::ios::trunc);
         if (ast_file.is_open()) {
             this->dump_to_stream(ast_file, 0);
             ast_file.close();
@@ -98,10 +126,69 @@ struct ASTNode {
     }
 };
 
+// Generic walkers over for_each_child. They keep the pending nodes on an explicit stack
+// instead of recursing, so a tree of any depth (a 300k-term expression is a chain that
+// deep) walks in constant native stack; the stack vector is their only allocation.
+// Children are visited in source order.
+// A pre-order visitor may return bool, false skips that node's children.
+template <typename F>
+void walkPreOrder(ASTNode* root, F&& visit) {
+    if (!root) return;
+    std::vector<ASTNode*> pending{root};
+    while (!pending.empty()) {
+        ASTNode* node = pending.back();
+        pending.pop_back();
+        if constexpr (std::is_same_v<std::invoke_result_t<F&, ASTNode*>, bool>) {
+            if (!visit(node)) continue;
+        } else {
+            visit(node);
+        }
+        size_t first = pending.size();
+        node->for_each_child([&pending](ASTNode* child) { pending.push_back(child); });
+        std::reverse(pending.begin() + first, pending.end()); // First child on top
+    }
+}
+
+template <typename F>
+void walkPostOrder(ASTNode* root, F&& visit) {
+    if (!root) return;
+    struct Pending {
+        ASTNode* node;
+        bool children_done; // Set once the node's children are on the stack above it
+    };
+    std::vector<Pending> pending{{root, false}};
+    while (!pending.empty()) {
+        Pending& top = pending.back();
+        if (top.children_done) {
+            ASTNode* node = top.node;
+            pending.pop_back();
+            visit(node);
+            continue;
+        }
+        top.children_done = true;
+        ASTNode* node = top.node;
+        size_t first = pending.size();
+        node->for_each_child([&pending](ASTNode* child) { pending.push_back({child, false}); });
+        std::reverse(pending.begin() + first, pending.end());
+    }
+}
+
+inline void NodeDeleter::operator()(ASTNode* node) const {
+    if (node && !arena_owned) delete node;
+}
+
+inline ASTArena::~ASTArena() {
+    while (last_node) {
+        ASTNode* node = last_node;
+        last_node = node->arena_prev;
+        node->~ASTNode();
+    }
+}
+
 // Node representing all literals
 struct LiteralExpressionNode : public ASTNode {
-    LiteralExpressionNode(NodeType type, int line, int column) 
-        : ASTNode(type, line, column) {}
+    LiteralExpressionNode(NodeType type, SourceLoc loc) 
+        : ASTNode(type, loc) {}
 
     virtual std::string getValueAsString() const = 0;
 };
@@ -114,8 +201,8 @@ struct IntegerLiteralExpressionNode : public LiteralExpressionNode {
     std::string get_value() const override { return getValueAsString(); }
     bool is_constant() const override { return true; }
 
-    IntegerLiteralExpressionNode(int val, int line = -1, int column = -1)
-        : LiteralExpressionNode(NodeType::INTEGER_LITERAL_EXPRESSION, line, column), value(val) {}
+    IntegerLiteralExpressionNode(int val, SourceLoc loc = NO_LOC)
+        : LiteralExpressionNode(NodeType::INTEGER_LITERAL_EXPRESSION, loc), value(val) {}
     std::string getValueAsString() const override { return std::to_string(value); }
 };
 
@@ -127,8 +214,8 @@ struct StringLiteralExpressionNode : public LiteralExpressionNode {
     std::string get_value() const override { return getValueAsString(); }
     bool is_constant() const override { return true; }
 
-    StringLiteralExpressionNode(std::string val, int line = -1, int column = -1)
-        : LiteralExpressionNode(NodeType::STRING_LITERAL_EXPRESSION, line, column), value(std::move(val)) {}
+    StringLiteralExpressionNode(std::string val, SourceLoc loc = NO_LOC)
+        : LiteralExpressionNode(NodeType::STRING_LITERAL_EXPRESSION, loc), value(std::move(val)) {}
     std::string getValueAsString() const override { return value; }
 };
 
@@ -140,8 +227,8 @@ struct BooleanLiteralExpressionNode : public LiteralExpressionNode {
     std::string get_value() const override { return getValueAsString(); }
     bool is_constant() const override { return true; }
 
-    BooleanLiteralExpressionNode(int val, int line = -1, int column = -1)
-        : LiteralExpressionNode(NodeType::BOOLEAN_LITERAL_EXPRESSION, line, column), value(val) {}
+    BooleanLiteralExpressionNode(int val, SourceLoc loc = NO_LOC)
+        : LiteralExpressionNode(NodeType::BOOLEAN_LITERAL_EXPRESSION, loc), value(val) {}
     std::string getValueAsString() const override { return std::to_string(value); }
 };
 
@@ -153,8 +240,8 @@ struct CharacterLiteralExpressionNode : public LiteralExpressionNode {
     std::string get_value() const override { return getValueAsString(); }
     bool is_constant() const override { return true; }
 
-    CharacterLiteralExpressionNode(int val, int line = -1, int column = -1)
-        : LiteralExpressionNode(NodeType::CHARACTER_LITERAL_EXPRESSION, line, column), value(val) {}
+    CharacterLiteralExpressionNode(int val, SourceLoc loc = NO_LOC)
+        : LiteralExpressionNode(NodeType::CHARACTER_LITERAL_EXPRESSION, loc), value(val) {}
     std::string getValueAsString() const override { return std::to_string(value); }
 };
 
@@ -167,8 +254,8 @@ struct FloatLiteralExpressionNode : public LiteralExpressionNode {
     std::string get_value() const override { return getValueAsString(); }
     bool is_constant() const override { return true; }
 
-    FloatLiteralExpressionNode(float val, int line = -1, int column = -1)
-        : LiteralExpressionNode(NodeType::FLOAT_LITERAL_EXPRESSION, line, column), value(val), label("") {}
+    FloatLiteralExpressionNode(float val, SourceLoc loc = NO_LOC)
+        : LiteralExpressionNode(NodeType::FLOAT_LITERAL_EXPRESSION, loc), value(val), label("") {}
     std::string getValueAsString() const override { return std::to_string(value); }
 };
 
@@ -181,101 +268,20 @@ struct DoubleLiteralExpressionNode : public LiteralExpressionNode {
     std::string get_value() const override { return getValueAsString(); }
     bool is_constant() const override { return true; }
 
-    DoubleLiteralExpressionNode(double val, int line = -1, int column = -1)
-        : LiteralExpressionNode(NodeType::DOUBLE_LITERAL_EXPRESSION, line, column), value(val), label("") {}
+    DoubleLiteralExpressionNode(double val, SourceLoc loc = NO_LOC)
+        : LiteralExpressionNode(NodeType::DOUBLE_LITERAL_EXPRESSION, loc), value(val), label("") {}
     std::string getValueAsString() const override { return std::to_string(value); }
 };
 
 // Node for return statements (e.g., return x;)
 struct ReturnStatementNode : public ASTNode {
-    std::unique_ptr<ASTNode> expression;
+    NodePtr<ASTNode> expression;
 
     std::string type_name() const override { return "RETURN_STMT:"; }
-    std::vector<ASTNode*> get_children() const override {
-        return { expression.get() };
-    }
+    void for_each_child(ChildVisitor visit) const override { visit(expression); }
 
-    ReturnStatementNode(std::unique_ptr<ASTNode> expr, int line = -1, int column = -1)
-	: ASTNode(NodeType::RETURN_STATEMENT, line, column), expression(std::move(expr)) {}
-};
-
-// Base class for type representations
-struct TypeNode {
-    enum class TypeCategory {
-        PRIMITIVE,
-        POINTER,
-        ARRAY,
-        STRUCT
-    };
-    TypeCategory category;
-    TypeNode(TypeCategory cat) : category(cat) {}
-    virtual ~TypeNode() = default;
-    virtual std::string typeName() const = 0;
-    virtual std::unique_ptr<TypeNode> clone() const = 0;
-};
-
-struct PrimitiveTypeNode : public TypeNode {
-    Token::Type primitive_type;
-    PrimitiveTypeNode(Token::Type type) : TypeNode(TypeCategory::PRIMITIVE), primitive_type(type) {}
-
-    std::string typeName() const override {
-        switch(primitive_type) {
-            case Token::KEYWORD_INT:    return "int";
-            case Token::KEYWORD_FLOAT:  return "float";
-            case Token::KEYWORD_DOUBLE: return "double";
-            case Token::KEYWORD_STRING: return "string";
-            case Token::KEYWORD_BOOL:   return "bool";
-            default: return "unknown_primitive";
-        }
-    }
-    std::unique_ptr<TypeNode> clone() const override {
-        return std::make_unique<PrimitiveTypeNode>(primitive_type);
-    }
-};
-
-struct PointerTypeNode : public TypeNode {
-    std::unique_ptr<TypeNode> base_type;
-    PointerTypeNode(std::unique_ptr<TypeNode> base) : TypeNode(TypeCategory::POINTER), base_type(std::move(base)) {}
-    std::string typeName() const override {
-        return base_type->typeName() + "*";
-    }
-    std::unique_ptr<TypeNode> clone() const override {
-        return std::make_unique<PointerTypeNode>(base_type->clone());
-    }
-};
-
-struct ArrayTypeNode : public TypeNode {
-    std::unique_ptr<TypeNode> base_type;
-    int size;
-
-    ArrayTypeNode(std::unique_ptr<TypeNode> base, int sz) : TypeNode(TypeCategory::ARRAY), base_type(std::move(base)), size(sz) {}
-    std::unique_ptr<TypeNode> clone() const override {
-        return std::make_unique<ArrayTypeNode>(base_type->clone(), size);
-    }
-    std::string typeName() const override {
-        return base_type->typeName() + "[" + std::to_string(size) + "]";
-    }
-};
-
-struct StructTypeNode : public TypeNode {
-    std::string struct_name;
-    StructTypeNode(std::string name) : TypeNode(TypeCategory::STRUCT), struct_name(std::move(name)) {}
-    std::unique_ptr<TypeNode> clone() const override {
-        return std::make_unique<StructTypeNode>(struct_name);
-    }
-    std::string typeName() const override {
-        return "struct " + struct_name;
-    }
-};
-
-struct AutoTypeNode : public TypeNode {
-    AutoTypeNode() : TypeNode(TypeCategory::PRIMITIVE) {} // Treat as primitive for simplicity, actual type deduced later
-    std::unique_ptr<TypeNode> clone() const override {
-        return std::make_unique<AutoTypeNode>();
-    }
-    std::string typeName() const override {
-        return "auto (deducing)";
-    }
+    ReturnStatementNode(NodePtr<ASTNode> expr, SourceLoc loc = NO_LOC)
+	: ASTNode(NodeType::RETURN_STATEMENT, loc), expression(std::move(expr)) {}
 };
 
 struct StructMember {
@@ -284,39 +290,47 @@ struct StructMember {
         PRIVATE
     };
 
-    std::unique_ptr<TypeNode> type;
-    std::string name;
+    const TypeNode* type;
+    Ident name;
     int offset;
     Visibility visibility = Visibility::PUBLIC; // Default to public
+    Symbol* symbol = nullptr; // Made once by the semantic analyzer, shared by every access
 };
 
 struct StructDefinitionNode : public ASTNode {
     std::string name;
     std::vector<StructMember> members;
-    int size;
+    int size;      // Size, alignment and member offsets are set by the LayoutTable
+    int align = 1;
+    // Layout attributes, `struct Name packed reorder align(N) { ... }`
+    bool packed = false;    // No padding, members at any offset
+    bool reorder = false;   // Members placed by decreasing alignment, to need the least padding
+    int explicit_align = 0; // align(N), 0 when not given
 
     std::string type_name() const override {
         std::string info = "STRUCT_DEF: " + name + " { ";
         for (const auto& m : members) {
-            info += m.name + " "; // Just the names for simplicity
+            info += spelling(m.name) + " "; // Just the names for simplicity
         }
         info += "}";
         return info;
     }
-    std::vector<ASTNode*> get_children() const override { return {}; }
-
-    StructDefinitionNode(std::string struct_name, int line = -1, int column = -1)
-        : ASTNode(NodeType::STRUCT_DEFINITION, line, column), name(std::move(struct_name)), size(0) {}
+    StructDefinitionNode(std::string struct_name, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::STRUCT_DEFINITION, loc), name(std::move(struct_name)), size(0) {}
 
     std::shared_ptr<StructDefinitionNode> clone() const {
-        auto new_node = std::make_shared<StructDefinitionNode>(name, line, column);
+        auto new_node = std::make_shared<StructDefinitionNode>(name, loc);
         new_node->size = size;
+        new_node->align = align;
+        new_node->packed = packed;
+        new_node->reorder = reorder;
+        new_node->explicit_align = explicit_align;
         for (const auto& m : members) {
             StructMember cloned_m;
             cloned_m.name = m.name;
             cloned_m.offset = m.offset;
             cloned_m.visibility = m.visibility;
-            cloned_m.type = m.type->clone();
+            cloned_m.type = m.type;
             new_node->members.push_back(std::move(cloned_m));
         }
         return new_node;
@@ -324,66 +338,62 @@ struct StructDefinitionNode : public ASTNode {
 };
 
 struct MemberAccessNode : public ASTNode {
-    std::unique_ptr<ASTNode> struct_expr; // The expression representing the struct instance
-    std::string member_name;
+    NodePtr<ASTNode> struct_expr; // The expression representing the struct instance
+    Ident member_name;
     Symbol* resolved_symbol;
 
-    std::string type_name() const override { return "MEMBER_ACCESS: " + member_name; }
+    std::string type_name() const override { return "MEMBER_ACCESS: " + spelling(member_name); }
+    void for_each_child(ChildVisitor visit) const override { visit(struct_expr); }
 
-    MemberAccessNode(std::unique_ptr<ASTNode> expr, std::string member, int line = -1, int column = -1)
-        : ASTNode(NodeType::MEMBER_ACCESS_EXPRESSION, line, column),
+    MemberAccessNode(NodePtr<ASTNode> expr, Ident member, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::MEMBER_ACCESS_EXPRESSION, loc),
           struct_expr(std::move(expr)),
-          member_name(std::move(member)),
+          member_name(member),
           resolved_symbol(nullptr) {}
 };
 
 struct NamespaceMember {
-    std::string name;
-    std::unique_ptr<ASTNode> node;
+    Ident name;
+    NodePtr<ASTNode> node;
 };
 
 class SymbolTable; // Forward declaration
 
 struct NamespaceDefinition : public ASTNode {
-    std::string name;
+    Ident name;
     std::vector<NamespaceMember> members;
     int size;
 
     SymbolTable* namespace_scope;
 
     std::string type_name() const override {
-        return "NAMESPACE_DEF: " + name;
+        return "NAMESPACE_DEF: " + spelling(name);
     }
 
-    std::vector<ASTNode*> get_children() const override {
-        std::vector<ASTNode*> children;
-        for (const auto& m : members) {
-            if (m.node) children.push_back(m.node.get());
-        }
-        return children;
+    void for_each_child(ChildVisitor visit) const override {
+        for (const auto& m : members) visit(m.node);
     }
 
-    NamespaceDefinition(std::string n, int line = -1, int column = -1)
-        : ASTNode(NodeType::NAMESPACE_DEFINITION, line, column), 
-          name(std::move(n)), namespace_scope(nullptr) {}
+    NamespaceDefinition(Ident n, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::NAMESPACE_DEFINITION, loc), 
+          name(n), namespace_scope(nullptr) {}
 };
 
-class ScopeResolutionNode : public ASTNode {
-public:
-    std::string namespace_name;
-    std::unique_ptr<ASTNode> member; 
+struct ScopeResolutionNode : public ASTNode {
+    Ident namespace_name;
+    NodePtr<ASTNode> member; 
     Symbol* resolved_symbol;
     std::string mangled_name; 
 
     std::string type_name() const override { 
-        return "SCOPE_RESOLUTION: " + namespace_name + "::"; 
+        return "SCOPE_RESOLUTION: " + spelling(namespace_name) + "::"; 
     }
 
-    std::vector<ASTNode*> get_children() const override { return { member.get() }; }
+    void for_each_child(ChildVisitor visit) const override { visit(member); }
 
-    ScopeResolutionNode(std::string ns, std::unique_ptr<ASTNode> mem, int line = -1, int column = -1)
-        : ASTNode(NodeType::SCOPE_RESOLUTION, line, column), // Use SCOPE_RESOLUTION here
-        namespace_name(std::move(ns)), 
+    ScopeResolutionNode(Ident ns, NodePtr<ASTNode> mem, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::SCOPE_RESOLUTION, loc), // Use SCOPE_RESOLUTION here
+        namespace_name(ns), 
         member(std::move(mem)),
         resolved_symbol(nullptr) {}
 
@@ -393,152 +403,170 @@ public:
 struct ExpressionNode; // Forward declaration
 
 struct Declaration {
-    std::string name;
-    std::unique_ptr<ASTNode> initial_value; 
+    Ident name;
+    NodePtr<ASTNode> initial_value; 
     Symbol* resolved_symbol = nullptr;
 };
 
 // Node for variable declarations (e.g., int/string x;)
 struct VariableDeclarationNode : public ASTNode {
-    std::unique_ptr<TypeNode> type;
+    const TypeNode* type;
     std::vector<Declaration> declarations;
+    int align = 0; // `align(N) int x;`, 0 when not given
 
     std::string type_name() const override { return "VAR_DECL"; }
-    std::vector<ASTNode*> get_children() const override {
-        std::vector<ASTNode*> refs;
-        for (auto& decl : declarations) {
-            if (decl.initial_value) refs.push_back(decl.initial_value.get());
-        }
-        return refs;
+    void for_each_child(ChildVisitor visit) const override {
+        for (auto& decl : declarations) visit(decl.initial_value);
     }
 
-    VariableDeclarationNode(std::unique_ptr<TypeNode> type, std::vector<Declaration> decls)
-        : ASTNode(NodeType::VARIABLE_DECLARATION), 
-          type(std::move(type)), 
+    VariableDeclarationNode(const TypeNode* type, std::vector<Declaration> decls, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::VARIABLE_DECLARATION, loc), 
+          type(type), 
           declarations(std::move(decls)) {}
 };
 
 // Node for variable assignments (e.g., x = 5;)
 struct VariableAssignmentNode : public ASTNode {
-    std::unique_ptr<ASTNode> left;
-    std::unique_ptr<ASTNode> right;
+    NodePtr<ASTNode> left;
+    NodePtr<ASTNode> right;
+
+    std::string type_name() const override { return "VAR_ASSIGN"; }
+    void for_each_child(ChildVisitor visit) const override {
+        visit(left);
+        visit(right);
+    }
 
-    VariableAssignmentNode(std::unique_ptr<ASTNode> left, std::unique_ptr<ASTNode> right, int line = -1, int column = -1)
-        : ASTNode(NodeType::VARIABLE_ASSIGNMENT, line, column),
+    VariableAssignmentNode(NodePtr<ASTNode> left, NodePtr<ASTNode> right, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::VARIABLE_ASSIGNMENT, loc),
           left(std::move(left)),
           right(std::move(right)) {}
 };
 
 // Node for variable references in expressions (e.g., x in x + 1)
 struct VariableReferenceNode : public ASTNode {
-    std::string name;
+    Ident name;
     Symbol* resolved_symbol;
     int resolved_offset;
     //std::unique_ptr<TypeNode> resolved_type;
     std::vector<std::string> scopes;
 
     std::string type_name() const override { return "VAR_REF:"; }
-    std::string get_value() const override { return name; }
+    std::string get_value() const override { return spelling(name); }
 
-    VariableReferenceNode(std::string var_name, int line = -1, int column = -1)
-        : ASTNode(NodeType::VARIABLE_REFERENCE, line, column), name(std::move(var_name)), resolved_symbol(nullptr), resolved_offset(0) {}
+    VariableReferenceNode(Ident var_name, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::VARIABLE_REFERENCE, loc), name(var_name), resolved_symbol(nullptr), resolved_offset(0) {}
 };
 
 // Node for unary operations.
 struct UnaryOpExpressionNode : public ASTNode {
     Token::Type op_type;
-    std::unique_ptr<ASTNode> operand;
+    NodePtr<ASTNode> operand;
     Symbol* resolved_symbol;
     //std::unique_ptr<TypeNode> resolved_type;
 
-    UnaryOpExpressionNode(Token::Type op, std::unique_ptr<ASTNode> operand_node, int line = -1, int column = -1)
-        : ASTNode(NodeType::UNARY_OP_EXPRESSION, line, column), op_type(op), operand(std::move(operand_node)), resolved_symbol(nullptr) {}
+    std::string type_name() const override { return "UNARY_OP"; }
+    void for_each_child(ChildVisitor visit) const override { visit(operand); }
+
+    UnaryOpExpressionNode(Token::Type op, NodePtr<ASTNode> operand_node, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::UNARY_OP_EXPRESSION, loc), op_type(op), operand(std::move(operand_node)), resolved_symbol(nullptr) {}
 };
 
 struct ArrayAccessNode : public ASTNode {
-    std::unique_ptr<ASTNode> array_expr;
-    std::unique_ptr<ASTNode> index_expr;
+    NodePtr<ASTNode> array_expr;
+    NodePtr<ASTNode> index_expr;
     Symbol* resolved_symbol;
 
     std::string type_name() const override { return "ARRAY_ACCESS"; }
-    std::vector<ASTNode*> get_children() const override {
-        return { array_expr.get(), index_expr.get() };
-    } 
+    void for_each_child(ChildVisitor visit) const override {
+        visit(array_expr);
+        visit(index_expr);
+    }
 
-    ArrayAccessNode(std::unique_ptr<ASTNode> array, std::unique_ptr<ASTNode> index, int line = -1, int column = -1)
-        : ASTNode(NodeType::ARRAY_ACCESS_EXPRESSION, line, column), array_expr(std::move(array)), index_expr(std::move(index)), resolved_symbol(nullptr) {}
+    ArrayAccessNode(NodePtr<ASTNode> array, NodePtr<ASTNode> index, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::ARRAY_ACCESS_EXPRESSION, loc), array_expr(std::move(array)), index_expr(std::move(index)), resolved_symbol(nullptr) {}
 };
 
 struct ParameterNode {
-    std::unique_ptr<TypeNode> type;
-    std::string name;
+    const TypeNode* type;
+    Ident name;
     int offset; // Add offset for parameter
 };
 
 
 // Node for function definitions (e.g., int main() {})
 struct FunctionDefinitionNode : public ASTNode {
-    std::unique_ptr<TypeNode> return_type;
-    std::string name;
+    const TypeNode* return_type;
+    Ident name;
     std::string mangled_name;
     std::vector<std::unique_ptr<ParameterNode>> parameters;
-    std::vector<std::unique_ptr<ASTNode>> body_statements;
+    std::vector<NodePtr<ASTNode>> body_statements;
 
-    std::string type_name() const override { return "FUNCTION_DEF: " + name; }
-    std::vector<ASTNode*> get_children() const override {
-        std::vector<ASTNode*> refs;
-        for (auto& stmt : body_statements) refs.push_back(stmt.get());
-        return refs;
+    std::string type_name() const override { return "FUNCTION_DEF: " + spelling(name); }
+    void for_each_child(ChildVisitor visit) const override {
+        for (auto& stmt : body_statements) visit(stmt);
     }
 
-    FunctionDefinitionNode(std::unique_ptr<TypeNode> ret_type, const std::string& func_name, int line = -1, int column = -1)
-        : ASTNode(NodeType::FUNCTION_DEFINITION, line, column),
-          return_type(std::move(ret_type)),
+    FunctionDefinitionNode(const TypeNode* ret_type, Ident func_name, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::FUNCTION_DEFINITION, loc),
+          return_type(ret_type),
 	            name(func_name), is_extern(false) {}
     bool is_extern;
+    int frame_size = 0; // Bytes of locals over all the function's scopes, set by the semantic analyzer
 };
 
 // Node for function calls
 struct FunctionCallNode : public ASTNode {
-    std::string function_name;
-    std::vector<std::unique_ptr<ASTNode>> arguments;
+    Ident function_name;
+    std::vector<NodePtr<ASTNode>> arguments;
     Symbol* resolved_symbol;
 
-    std::string type_name() const override { return "FUNC_CALL: " + function_name; }
-    std::vector<ASTNode*> get_children() const override {
-        std::vector<ASTNode*> refs;
-        for (auto& arg : arguments) refs.push_back(arg.get());
-        return refs;
+    std::string type_name() const override { return "FUNC_CALL: " + spelling(function_name); }
+    void for_each_child(ChildVisitor visit) const override {
+        for (auto& arg : arguments) visit(arg);
     }
 
-    FunctionCallNode(std::string name, std::vector<std::unique_ptr<ASTNode>> args, int line = -1, int column = -1)
-        : ASTNode(NodeType::FUNCTION_CALL, line, column),
-          function_name(std::move(name)),
+    FunctionCallNode(Ident name, std::vector<NodePtr<ASTNode>> args, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::FUNCTION_CALL, loc),
+          function_name(name),
           arguments(std::move(args)),
           resolved_symbol(nullptr) {}
 };
 
 // Node for while statements
 struct WhileStatementNode : public ASTNode {
-    std::unique_ptr<ASTNode> condition;
-    std::vector<std::unique_ptr<ASTNode>> body;
+    NodePtr<ASTNode> condition;
+    std::vector<NodePtr<ASTNode>> body;
+
+    std::string type_name() const override { return "WHILE_STMT"; }
+    void for_each_child(ChildVisitor visit) const override {
+        visit(condition);
+        for (auto& stmt : body) visit(stmt);
+    }
 
-    WhileStatementNode(std::unique_ptr<ASTNode> cond, std::vector<std::unique_ptr<ASTNode>> body_stmts, int line = -1, int column = -1)
-        : ASTNode(NodeType::WHILE_STATEMENT, line, column),
+    WhileStatementNode(NodePtr<ASTNode> cond, std::vector<NodePtr<ASTNode>> body_stmts, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::WHILE_STATEMENT, loc),
           condition(std::move(cond)),
           body(std::move(body_stmts)) {}
 };
 
 // Node for for statements
 struct ForStatementNode : public ASTNode {
-    std::unique_ptr<ASTNode> initializer;
-    std::unique_ptr<ASTNode> condition;
-    std::unique_ptr<ASTNode> increment;
-    std::vector<std::unique_ptr<ASTNode>> body;
-
-    ForStatementNode(std::unique_ptr<ASTNode> init, std::unique_ptr<ASTNode> cond, std::unique_ptr<ASTNode> incr, std::vector<std::unique_ptr<ASTNode>> body_stmts,
-                     int line = -1, int column = -1)
-        : ASTNode(NodeType::FOR_STATEMENT, line, column),
+    NodePtr<ASTNode> initializer;
+    NodePtr<ASTNode> condition;
+    NodePtr<ASTNode> increment;
+    std::vector<NodePtr<ASTNode>> body;
+
+    std::string type_name() const override { return "FOR_STMT"; }
+    void for_each_child(ChildVisitor visit) const override {
+        visit(initializer);
+        visit(condition);
+        visit(increment);
+        for (auto& stmt : body) visit(stmt);
+    }
+
+    ForStatementNode(NodePtr<ASTNode> init, NodePtr<ASTNode> cond, NodePtr<ASTNode> incr, std::vector<NodePtr<ASTNode>> body_stmts,
+                     SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::FOR_STATEMENT, loc),
           initializer(std::move(init)),
           condition(std::move(cond)),
           increment(std::move(incr)),
@@ -547,18 +575,19 @@ struct ForStatementNode : public ASTNode {
 
 // Node for Arthemetic expression
 struct BinaryOperationExpressionNode : public ASTNode {
-    std::unique_ptr<ASTNode> left;
+    NodePtr<ASTNode> left;
     Token::Type op_type;
-    std::unique_ptr<ASTNode> right;
+    NodePtr<ASTNode> right;
     //std::unique_ptr<TypeNode> resolved_type;
 
     std::string type_name() const override { return "BINARY_OP: "; }
-    std::vector<ASTNode*> get_children() const override {
-        return { left.get(), right.get() };
+    void for_each_child(ChildVisitor visit) const override {
+        visit(left);
+        visit(right);
     }
 
-    BinaryOperationExpressionNode(std::unique_ptr<ASTNode> left_expr, Token::Type op, std::unique_ptr<ASTNode> right_expr, int line = -1, int column = -1)
-        : ASTNode(NodeType::BINARY_OPERATION_EXPRESSION, line, column),
+    BinaryOperationExpressionNode(NodePtr<ASTNode> left_expr, Token::Type op, NodePtr<ASTNode> right_expr, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::BINARY_OPERATION_EXPRESSION, loc),
           left(std::move(left_expr)),
           op_type(op),
           right(std::move(right_expr)) {}
@@ -566,39 +595,35 @@ struct BinaryOperationExpressionNode : public ASTNode {
 
 // Node for print statements (e.g., 'print x, "hello";')
 struct PrintStatementNode : public ASTNode {
-    std::vector<std::unique_ptr<ASTNode>> expressions;
+    std::vector<NodePtr<ASTNode>> expressions;
 
     std::string type_name() const override { return "PRINT_STMT"; }
-    std::vector<ASTNode*> get_children() const override {
-        std::vector<ASTNode*> refs;
-        for (auto& expr : expressions) refs.push_back(expr.get());
-        return refs;
+    void for_each_child(ChildVisitor visit) const override {
+        for (auto& expr : expressions) visit(expr);
     }
 
-    PrintStatementNode(std::vector<std::unique_ptr<ASTNode>> exprs, int line = -1, int column = -1)
-        : ASTNode(NodeType::PRINT_STATEMENT, line, column),
+    PrintStatementNode(std::vector<NodePtr<ASTNode>> exprs, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::PRINT_STATEMENT, loc),
           expressions(std::move(exprs)) {}
 };
 
 // Node for if statements.
 struct IfStatementNode : public ASTNode {
-    std::unique_ptr<ASTNode> condition;
-    std::vector<std::unique_ptr<ASTNode>> true_block;
-    std::vector<std::unique_ptr<ASTNode>> false_block;
+    NodePtr<ASTNode> condition;
+    std::vector<NodePtr<ASTNode>> true_block;
+    std::vector<NodePtr<ASTNode>> false_block;
 
     std::string type_name() const override { return "IF_STATEMENT"; }
-    std::vector<ASTNode*> get_children() const override {
-        std::vector<ASTNode*> refs;
-        if (condition) refs.push_back(condition.get());
-        for (auto& stmt : true_block) refs.push_back(stmt.get());
-        for (auto& stmt : false_block) refs.push_back(stmt.get());
-        return refs;
+    void for_each_child(ChildVisitor visit) const override {
+        visit(condition);
+        for (auto& stmt : true_block) visit(stmt);
+        for (auto& stmt : false_block) visit(stmt);
     }
 
-    IfStatementNode(std::unique_ptr<ASTNode> cond, std::vector<std::unique_ptr<ASTNode>> t_block,
-                    std::vector<std::unique_ptr<ASTNode>> f_block = {},
-                    int line = -1, int column = -1)
-        : ASTNode(NodeType::IF_STATEMENT, line, column),
+    IfStatementNode(NodePtr<ASTNode> cond, std::vector<NodePtr<ASTNode>> t_block,
+                    std::vector<NodePtr<ASTNode>> f_block = {},
+                    SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::IF_STATEMENT, loc),
           condition(std::move(cond)),
           true_block(std::move(t_block)),
           false_block(std::move(f_block)) {}
@@ -606,13 +631,13 @@ struct IfStatementNode : public ASTNode {
 
 // Node for switch statements.
 struct CaseNode {
-    std::unique_ptr<ASTNode> constant_expr;
-    std::vector<std::unique_ptr<ASTNode>> body;
+    NodePtr<ASTNode> constant_expr;
+    std::vector<NodePtr<ASTNode>> body;
     bool is_default = false;
 };
 
 struct SwitchStatementNode : public ASTNode {
-    std::unique_ptr<ASTNode> condition;
+    NodePtr<ASTNode> condition;
     std::vector<CaseNode> cases;
 
     bool use_jump_table = false;
@@ -620,83 +645,115 @@ struct SwitchStatementNode : public ASTNode {
     long long max_case = 0;
 
     std::string type_name() const override { return "SWITCH_STATEMENT"; }
-    std::vector<ASTNode*> get_children() const override {
-        std::vector<ASTNode*> refs;
-        if (condition) refs.push_back(condition.get());
+    void for_each_child(ChildVisitor visit) const override {
+        visit(condition);
         for (auto& c : cases) {
-            if (c.constant_expr) refs.push_back(c.constant_expr.get());
-            for (auto& stmt : c.body) {
-                refs.push_back(stmt.get());
-            }
+            visit(c.constant_expr);
+            for (auto& stmt : c.body) visit(stmt);
         }
-        return refs;
     }
 
-    SwitchStatementNode(int line = -1, int column = -1) 
-        : ASTNode(NodeType::SWITCH_STATEMENT, line, column) {}
+    SwitchStatementNode(SourceLoc loc = NO_LOC) 
+        : ASTNode(NodeType::SWITCH_STATEMENT, loc) {}
 };
 
 // Root node that contains all program statements
 struct ProgramNode : public ASTNode {
-    std::vector<std::unique_ptr<ASTNode>> statements;
-    std::vector<std::unique_ptr<FunctionDefinitionNode>> functions;
-    std::vector<std::unique_ptr<StructDefinitionNode>> structs;
-
-    std::vector<ASTNode*> get_children() const override {
-        std::vector<ASTNode*> refs;
-        for (auto& stmt : statements) refs.push_back(stmt.get());
-        for (auto& func : functions) refs.push_back(func.get());
-        for (auto& str : structs) refs.push_back(str.get());
-        return refs;
+    // Function bodies from a parallel parse. Declared first so they outlive the function
+    // nodes in arena, whose body_statements still point into them while being destroyed.
+    std::vector<std::unique_ptr<ASTArena>> worker_arenas;
+    ASTArena arena; // Every other node below lives here, destroyed after the lists that point into it
+    std::vector<NodePtr<ASTNode>> statements;
+    std::vector<NodePtr<FunctionDefinitionNode>> functions;
+    std::vector<NodePtr<StructDefinitionNode>> structs;
+
+    void for_each_child(ChildVisitor visit) const override {
+        for (auto& stmt : statements) visit(stmt);
+        for (auto& func : functions) visit(func);
+        for (auto& str : structs) visit(str);
     }
 
     std::string type_name() const override { return "PROGRAM_ROOT"; }
 
-    ProgramNode(int line = -1, int column = -1)
-        : ASTNode(NodeType::PROGRAM, line, column) {}
+    ProgramNode(SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::PROGRAM, loc) {}
 };
 
 
 // Node for inline assembly blocks
 struct AsmStatementNode : public ASTNode {
     std::vector<std::string> lines;
-    AsmStatementNode(std::vector<std::string> asm_lines, int line = -1, int column = -1)
-        : ASTNode(NodeType::ASM_STATEMENT, line, column), lines(std::move(asm_lines)) {}
+
+    std::string type_name() const override { return "ASM_STMT"; }
+
+    AsmStatementNode(std::vector<std::string> asm_lines, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::ASM_STATEMENT, loc), lines(std::move(asm_lines)) {}
 };
 
 // Node for constant declarations (e.g., const int x = 5;)
 struct ConstantDeclarationNode : public ASTNode {
-    std::string name;
-    std::unique_ptr<TypeNode> type;
-    std::unique_ptr<ASTNode> initial_value;
+    Ident name;
+    const TypeNode* type;
+    NodePtr<ASTNode> initial_value;
     Symbol* resolved_symbol;
 
-    std::string type_name() const override { return "CONST_DECL: " + name; }
-    std::vector<ASTNode*> get_children() const override {
-        return { initial_value.get() };
-    }
+    std::string type_name() const override { return "CONST_DECL: " + spelling(name); }
+    void for_each_child(ChildVisitor visit) const override { visit(initial_value); }
 
-    ConstantDeclarationNode(std::string name, std::unique_ptr<TypeNode> type, std::unique_ptr<ASTNode> initial_val, int line = -1, int column = -1)
-        : ASTNode(NodeType::CONSTANT_DECLARATION, line, column), name(std::move(name)), type(std::move(type)), initial_value(std::move(initial_val)), resolved_symbol(nullptr) {}
+    ConstantDeclarationNode(Ident name, const TypeNode* type, NodePtr<ASTNode> initial_val, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::CONSTANT_DECLARATION, loc), name(name), type(type), initial_value(std::move(initial_val)), resolved_symbol(nullptr) {}
 };
 
 struct EnumMemberNode {
-    std::string name;
-    std::unique_ptr<ASTNode> value; // Can be nullptr for implicit values
+    Ident name;
+    NodePtr<ASTNode> value; // Can be nullptr for implicit values
 
-    EnumMemberNode(std::string name, std::unique_ptr<ASTNode> value = nullptr)
-        : name(std::move(name)), value(std::move(value)) {}
+    EnumMemberNode(Ident name, NodePtr<ASTNode> value = nullptr)
+        : name(name), value(std::move(value)) {}
 };
 
 struct EnumStatementNode : public ASTNode {
-    std::string name;
+    Ident name;
     std::vector<std::unique_ptr<EnumMemberNode>> members;
 
-    std::string type_name() const override { return "ENUM: " + name; }
-    std::vector<ASTNode*> get_children() const override { return {}; }
+    std::string type_name() const override { return "ENUM: " + spelling(name); }
+    void for_each_child(ChildVisitor visit) const override {
+        for (auto& member : members) visit(member->value);
+    }
+
+    EnumStatementNode(Ident name, std::vector<std::unique_ptr<EnumMemberNode>> members, SourceLoc loc = NO_LOC)
+        : ASTNode(NodeType::ENUM_STATEMENT, loc), name(name), members(std::move(members)) {}
+};
 
-    EnumStatementNode(std::string name, std::vector<std::unique_ptr<EnumMemberNode>> members, int line = -1, int column = -1)
-        : ASTNode(NodeType::ENUM_STATEMENT, line, column), name(std::move(name)), members(std::move(members)) {}
+inline const char* nodeTypeName(ASTNode::NodeType type) {
+    static const char* names[] = {
+#define AS_NODE_NAME(type, node_class, name) name,
+        AST_NODE_LIST(AS_NODE_NAME)
+#undef AS_NODE_NAME
+    };
+    size_t index = static_cast<size_t>(type);
+    return index < sizeof(names) / sizeof(names[0]) ? names[index] : "UNKNOWN";
+}
+
+// CRTP base for passes over the tree. dispatch() is one switch generated from
+// AST_NODE_LIST that calls Derived::visit(NodeClass*) directly, no virtual calls.
+// Every node kind needs its own exact visit overload: the member pointer cast below
+// doesn't accept a visit(ASTNode*) fallback, so a new kind is a compile error in every
+// pass until it handles it. Derived classes with private visits befriend ASTVisitor.
+template <typename Derived, typename Result = void>
+class ASTVisitor {
+public:
+    Result dispatch(ASTNode* node) {
+        Derived& self = static_cast<Derived&>(*this);
+        switch (node->node_type) {
+#define AS_VISIT_CASE(type, node_class, name) \
+            case ASTNode::NodeType::type: \
+                return (self.*static_cast<Result (Derived::*)(node_class*)>(&Derived::visit))(static_cast<node_class*>(node));
+            AST_NODE_LIST(AS_VISIT_CASE)
+#undef AS_VISIT_CASE
+        }
+        throw std::runtime_error("Unknown AST node type " + std::to_string(static_cast<int>(node->node_type)));
+    }
 };
 
 #endif // AST_HPP
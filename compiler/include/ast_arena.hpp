@@ -0,0 +1,88 @@
+#ifndef AST_ARENA_HPP
+#define AST_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+struct ASTNode;
+
+// Deleter for AST node pointers. Nodes that live in an ASTArena are left alone, the arena
+// destroys them all at once. Nodes made on the heap (makeNode, used by later phases for
+// the odd synthesized node) are deleted normally.
+// Whether the node is the arena's is kept here, not in the node: the arena destroys the
+// newest node first, which is often a child, and the parent's NodePtr to it must not look
+// at the node once it is gone.
+struct NodeDeleter {
+    bool arena_owned = false;
+    void operator()(ASTNode* node) const; // Defined in ast.hpp, needs the complete ASTNode
+};
+
+template <typename T>
+using NodePtr = std::unique_ptr<T, NodeDeleter>;
+
+// Heap-allocated node, for code that has no arena at hand
+template <typename T, typename... Args>
+NodePtr<T> makeNode(Args&&... args) {
+    return NodePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+// Bump allocator for AST nodes. Owned by the ProgramNode, so it has to outlive every
+// node allocated from it; ProgramNode declares it as its first member for that reason.
+// The arena also runs the node destructors, in one flat loop, so tearing down a very
+// deep tree (a generated expression with 100k operators) doesn't recurse per level.
+// That is still one destructor call per node: nodes own strings, vectors and heap-made
+// children. What the arena saves is the per-node free, its blocks go all at once.
+class ASTArena {
+public:
+    ASTArena() = default;
+    ASTArena(const ASTArena&) = delete;
+    ASTArena& operator=(const ASTArena&) = delete;
+    ~ASTArena(); // Defined in ast.hpp, needs the complete ASTNode
+
+    template <typename T, typename... Args>
+    NodePtr<T> make(Args&&... args) {
+        T* node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        node->arena_prev = last_node;
+        last_node = node;
+        return NodePtr<T>(node, NodeDeleter{true});
+    }
+
+    void* allocate(size_t size, size_t align) {
+        size_t padding = (align - reinterpret_cast<uintptr_t>(cursor) % align) % align;
+        if (cursor == nullptr || padding + size > static_cast<size_t>(limit - cursor)) {
+            grow(size + align);
+            padding = (align - reinterpret_cast<uintptr_t>(cursor) % align) % align;
+        }
+        void* result = cursor + padding;
+        cursor += padding + size;
+        return result;
+    }
+
+    size_t bytesReserved() const { return reserved; }
+
+private:
+    static constexpr size_t FIRST_BLOCK = 64 * 1024;
+    static constexpr size_t MAX_BLOCK = 1024 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    ASTNode* last_node = nullptr; // Newest node, the rest are chained through ASTNode::arena_prev
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t next_block = FIRST_BLOCK;
+    size_t reserved = 0;
+
+    void grow(size_t at_least) {
+        size_t size = next_block > at_least ? next_block : at_least;
+        blocks.emplace_back(new char[size]);
+        cursor = blocks.back().get();
+        limit = cursor + size;
+        reserved += size;
+        if (next_block < MAX_BLOCK) next_block *= 2;
+    }
+};
+
+#endif // AST_ARENA_HPP
@@ -0,0 +1,27 @@
+#ifndef AST_CACHE_HPP
+#define AST_CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "ast.hpp"
+
+// On-disk cache of a parsed AST, so an unchanged unit can skip lexing and parsing.
+// The file holds no pointers: identifiers and types are written once into tables and
+// referred to by index, and the nodes follow in pre-order. Loading maps the file and
+// rebuilds the tree in a fresh ProgramNode's arena.
+// A cache file is only used if it was written for the same source hash by the same
+// compiler version in the same format, with the same token and node lists; anything
+// else counts as a miss.
+
+constexpr uint32_t AST_CACHE_FORMAT = 5; // Bump whenever the node layout on disk changes
+
+uint64_t hashSource(std::string_view text); // 64-bit FNV-1a
+
+// Neither throws. A failed write leaves no file behind, a failed load returns nullptr
+// and the caller parses the source as usual.
+bool writeASTCache(const std::string& path, const ProgramNode& program, uint64_t source_hash);
+std::unique_ptr<ProgramNode> loadASTCache(const std::string& path, uint64_t source_hash);
+
+#endif // AST_CACHE_HPP
@@ -0,0 +1,67 @@
+#ifndef AST_EXPORT_HPP
+#define AST_EXPORT_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include "ast.hpp"
+
+// Structured AST export for tools (--emit-ast=json|bin). Unlike ast.txt, every node
+// record carries its id, kind, source position, resolved type and resolved symbol, so a
+// tool doesn't have to re-parse indented text. Meant to run after semantic analysis,
+// before that the type and symbol fields are simply empty.
+//
+// Node ids are pre-order indices. The JSON form nests children inside their parent.
+// The binary form is made for random access into very large dumps: a header, a table of
+// fixed-size node records in id order, a string table and an index of the function
+// definitions. A node's subtree is exactly the records [id, subtree_end), so a tool can
+// load one function with one seek and one read.
+// Both forms are written from one flat table that is built in memory first, so an
+// export holds a record (40 bytes) per node plus the strings until it is done.
+
+constexpr uint32_t AST_EXPORT_FORMAT = 3;
+
+enum class ASTExportFormat { JSON, BINARY };
+
+#pragma pack(push, 1)
+struct ASTExportHeader {
+    char magic[8];             // "NYTASTX\0"
+    uint32_t format;           // AST_EXPORT_FORMAT
+    uint32_t node_count;
+    uint32_t string_count;
+    uint32_t function_count;
+    uint64_t nodes_offset;     // node_count ASTExportRecord
+    uint64_t strings_offset;   // string_count + 1 u64 offsets into the string bytes, then the bytes
+    uint64_t functions_offset; // function_count ASTExportFunction
+};
+
+struct ASTExportRecord {
+    uint16_t kind;         // ASTNode::NodeType
+    uint8_t symbol_kind;   // Symbol::SymbolType + 1, 0 when unresolved
+    uint8_t reserved = 0;
+    int32_t line;          // In the original file, resolved through the SourceManager
+    int32_t column;
+    uint32_t parent;       // Id of the parent, the root's parent is itself
+    uint32_t subtree_end;  // One past the id of the last descendant
+    // Strings are indices into the string table, 0 is "" and means none
+    uint32_t label;        // String: the node's name or literal value
+    uint32_t type;         // String: resolved type
+    uint32_t symbol;       // String: resolved symbol name
+    uint32_t file;         // String: original file the node came from
+};
+
+struct ASTExportFunction {
+    uint32_t name;         // String
+    uint32_t node;         // Id of the FUNCTION_DEF record
+};
+#pragma pack(pop)
+
+struct ASTExportOptions {
+    ASTExportFormat format = ASTExportFormat::JSON;
+    std::unordered_set<std::string> functions; // Only these function bodies when not empty
+};
+
+// Throws std::runtime_error if the file can't be written
+void exportAST(const ProgramNode& program, const std::string& path, const ASTExportOptions& options);
+
+#endif // AST_EXPORT_HPP
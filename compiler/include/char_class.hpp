@@ -0,0 +1,157 @@
+#ifndef CHAR_CLASS_HPP
+#define CHAR_CLASS_HPP
+
+#include "token_list.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Lexer tables shared by the compiler and the preprocessor, generated at compile time
+// from TOKEN_LIST so adding a token there is all it takes.
+//  - CHAR_CLASS maps every byte to the kind of token it can start.
+//  - The operator DFA recognizes the longest punctuator with one lookup per byte.
+// Token ids here are TOKEN_LIST positions, which is exactly the numbering of Token::Type.
+namespace lex {
+
+enum CharClass : uint8_t {
+    CC_OTHER,         // Can't start a token
+    CC_SPACE,
+    CC_DIGIT,
+    CC_IDENT,         // Letters and '_'
+    CC_CHAR_QUOTE,
+    CC_STRING_QUOTE,
+    CC_OPERATOR,      // First byte of some punctuator
+};
+
+constexpr std::string_view TOKEN_SPELLINGS[] = {
+#define AS_SPELLING(name, str) str,
+    TOKEN_LIST(AS_SPELLING)
+#undef AS_SPELLING
+};
+constexpr size_t TOKEN_COUNT = sizeof(TOKEN_SPELLINGS) / sizeof(TOKEN_SPELLINGS[0]);
+
+constexpr uint8_t NO_TOKEN = 0xFF;
+constexpr uint8_t LINE_COMMENT = 0xFE; // "//", matched by the DFA but not a token
+static_assert(TOKEN_COUNT < LINE_COMMENT, "Token ids have to fit in a byte.");
+
+constexpr bool isPunctuatorByte(char c) {
+    return c > ' ' && c < 0x7F && c != '"' && c != '\'' && c != '_' &&
+           !(c >= 'a' && c <= 'z') && !(c >= 'A' && c <= 'Z') && !(c >= '0' && c <= '9');
+}
+
+// Operators are the entries spelled entirely with punctuation, labels like "INT_LIT" never are.
+constexpr bool isPunctuator(std::string_view text) {
+    if (text.empty()) return false;
+    for (char c : text) {
+        if (!isPunctuatorByte(c)) return false;
+    }
+    return true;
+}
+
+constexpr std::array<uint8_t, 256> buildCharClasses() {
+    std::array<uint8_t, 256> table = {};
+    for (int c = 0; c < 256; ++c) {
+        if (c == ' ' || (c >= '\t' && c <= '\r')) table[c] = CC_SPACE;
+        else if (c >= '0' && c <= '9') table[c] = CC_DIGIT;
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') table[c] = CC_IDENT;
+        else if (c == '\'') table[c] = CC_CHAR_QUOTE;
+        else if (c == '"') table[c] = CC_STRING_QUOTE;
+        else table[c] = CC_OTHER;
+    }
+    for (std::string_view text : TOKEN_SPELLINGS) {
+        if (isPunctuator(text)) table[static_cast<unsigned char>(text[0])] = CC_OPERATOR;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> CHAR_CLASS = buildCharClasses();
+
+constexpr CharClass classOf(char c) {
+    return static_cast<CharClass>(CHAR_CLASS[static_cast<unsigned char>(c)]);
+}
+
+constexpr bool isIdentifierChar(char c) {
+    CharClass cc = classOf(c);
+    return cc == CC_IDENT || cc == CC_DIGIT;
+}
+
+// Operator DFA. Bytes are first squeezed into columns (0 = not used by any operator)
+// so the transition table stays a few hundred bytes and sits in L1.
+constexpr size_t MAX_OPERATOR_COLUMNS = 32;
+constexpr size_t MAX_OPERATOR_STATES = 64;
+constexpr uint8_t OP_DEAD = 0;
+constexpr uint8_t OP_START = 1;
+
+struct OperatorColumns {
+    uint8_t of[256];
+    uint8_t count;
+};
+
+constexpr OperatorColumns buildOperatorColumns() {
+    OperatorColumns columns = {};
+    columns.count = 1;
+    auto add = [&columns](std::string_view text) {
+        for (char c : text) {
+            uint8_t& column = columns.of[static_cast<unsigned char>(c)];
+            if (column == 0) column = columns.count++;
+        }
+    };
+    for (std::string_view text : TOKEN_SPELLINGS) {
+        if (isPunctuator(text)) add(text);
+    }
+    add("//");
+    return columns;
+}
+
+inline constexpr OperatorColumns OPERATOR_COLUMNS = buildOperatorColumns();
+static_assert(OPERATOR_COLUMNS.count <= MAX_OPERATOR_COLUMNS, "Too many operator characters, grow MAX_OPERATOR_COLUMNS.");
+
+struct OperatorDfa {
+    uint8_t next[MAX_OPERATOR_STATES][MAX_OPERATOR_COLUMNS];
+    uint8_t accept[MAX_OPERATOR_STATES]; // Token id, or NO_TOKEN
+    uint8_t states;
+};
+
+constexpr OperatorDfa buildOperatorDfa() {
+    OperatorDfa dfa = {};
+    for (auto& token : dfa.accept) token = NO_TOKEN;
+    dfa.states = OP_START + 1;
+    auto add = [&dfa](std::string_view text, uint8_t token) {
+        uint8_t state = OP_START;
+        for (char c : text) {
+            uint8_t& next = dfa.next[state][OPERATOR_COLUMNS.of[static_cast<unsigned char>(c)]];
+            if (next == OP_DEAD) next = dfa.states++;
+            state = next;
+        }
+        dfa.accept[state] = token;
+    };
+    for (size_t i = 0; i < TOKEN_COUNT; ++i) {
+        if (isPunctuator(TOKEN_SPELLINGS[i])) add(TOKEN_SPELLINGS[i], static_cast<uint8_t>(i));
+    }
+    add("//", LINE_COMMENT);
+    return dfa;
+}
+
+inline constexpr OperatorDfa OPERATOR_DFA = buildOperatorDfa();
+static_assert(OPERATOR_DFA.states <= MAX_OPERATOR_STATES, "Too many operator states, grow MAX_OPERATOR_STATES.");
+
+// Longest punctuator at the start of text (maximal munch).
+// Returns its length, 0 if there is none, and stores its token id in `token`.
+constexpr size_t matchOperator(std::string_view text, uint8_t& token) {
+    size_t matched = 0;
+    uint8_t state = OP_START;
+    for (size_t i = 0; i < text.size(); ++i) {
+        state = OPERATOR_DFA.next[state][OPERATOR_COLUMNS.of[static_cast<unsigned char>(text[i])]];
+        if (state == OP_DEAD) break;
+        if (OPERATOR_DFA.accept[state] != NO_TOKEN) {
+            token = OPERATOR_DFA.accept[state];
+            matched = i + 1;
+        }
+    }
+    return matched;
+}
+
+} // namespace lex
+
+#endif // CHAR_CLASS_HPP
@@ -10,18 +10,28 @@
 #include <map>
 #include "ast.hpp"
 #include "symbol_table.hpp"
+#include "type_layout.hpp"
 
 struct GlobalConstant {
     std::string label;
     std::string type;
     std::string value;
+    int align = 1; // Padded up to this with zero bytes before the label
 };
 
-class CodeGenerator {
+class CodeGenerator : public ASTVisitor<CodeGenerator> {
+    friend class ASTVisitor<CodeGenerator>;
+
 public:
     CodeGenerator(std::unique_ptr<ProgramNode>& ast, SymbolTable& symTable);
     void generate(const std::string& output_filename, bool is_entry_point);
-    bool isFloatingPoint(const std::shared_ptr<TypeNode>& type);
+    // generate() in steps. With stream set, the global statements are generated by begin()
+    // and each function by generateFunction() as soon as it is analyzed, its .data
+    // entries flushed right behind it.
+    void begin(const std::string& output_filename, bool is_entry_point, bool stream);
+    void generateFunction(FunctionDefinitionNode* func);
+    void finish();
+    bool isFloatingPoint(const TypeNode* type);
     bool debug_mode = false;
 
 private:
@@ -35,6 +45,10 @@ private:
     std::unique_ptr<ProgramNode>& program_ast;
     SymbolTable& symbolTable;
     std::ofstream out;
+    bool streaming = false;
+
+    void declareFunction(const FunctionDefinitionNode* func);
+    void flushConstants();
 
     void visit(ASTNode* node);
     void visit(ProgramNode* node);
@@ -66,19 +80,16 @@ private:
     void visit(NamespaceDefinition* node);
     void visit(ScopeResolutionNode* node);
 
-    int getTypeSize(const TypeNode* type);
 
     // Instruction set
     void emit(const std::string& instr);
     void emit(const std::string& instr, const std::string reg);
     void emit(const std::string& instr, const std::string& dest, const std::string& src);
-    void emit_adv(const std::shared_ptr<TypeNode>& type, const std::string& base_reg, int offset, const std::string& src_val);
-    void emit_adv(const std::unique_ptr<TypeNode>& type, const std::string& base_reg, int offset, const std::string& src_val);
+    void emit_adv(const TypeNode* type, const std::string& base_reg, int offset, const std::string& src_val);
     void emit_binary_op(const std::string& op_instr, char type);
     void call_external(const std::string& func_name);
-    void emit_print(const std::shared_ptr<TypeNode>& type);
-    void load_adv(const std::shared_ptr<TypeNode>& type, const std::string& dest_reg, const std::string base_reg, int offset);
-    void load_adv(const std::unique_ptr<TypeNode>& type, const std::string& dest_reg, const std::string& base_reg, int offset);
+    void emit_print(const TypeNode* type);
+    void load_adv(const TypeNode* type, const std::string& dest_reg, const std::string base_reg, int offset);
 };
 
 #endif // CODE_GENERATOR_HPP
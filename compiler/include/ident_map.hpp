@@ -0,0 +1,75 @@
+#ifndef IDENT_MAP_HPP
+#define IDENT_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "interner.hpp"
+
+// Open-addressing hash map from interned identifiers to small values, used for the
+// symbol scopes. Keys are already small integers, so the hash is a single multiply
+// (Fibonacci hashing) and a probe compares two u32s in a flat array.
+// Linear probing, never more than half full, so a hit or a miss takes a probe or two.
+// Values are stored in the slots and move when the map grows, so a pointer returned by
+// find or emplace is only good until the next insert. The scopes store Symbol pointers,
+// the symbols themselves live in the SymbolTable's pools.
+template <typename T>
+class IdentMap {
+public:
+    T* find(Ident key) {
+        if (slots.empty()) return nullptr;
+        for (size_t i = home(key);; i = (i + 1) & mask()) {
+            Slot& slot = slots[i];
+            if (slot.key == NO_IDENT) return nullptr;
+            if (slot.key == key) return &slot.value;
+        }
+    }
+
+    // Like unordered_map::emplace: an existing entry is kept and returned with false
+    std::pair<T*, bool> emplace(Ident key, T value) {
+        if ((count + 1) * 2 > slots.size()) grow();
+        size_t i = home(key);
+        for (; slots[i].key != NO_IDENT; i = (i + 1) & mask()) {
+            if (slots[i].key == key) return {&slots[i].value, false};
+        }
+        slots[i].key = key;
+        slots[i].value = std::move(value);
+        count++;
+        return {&slots[i].value, true};
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    static constexpr size_t FIRST_CAPACITY = 8; // Most scopes hold a handful of names
+
+    struct Slot {
+        Ident key = NO_IDENT; // NO_IDENT marks an empty slot
+        T value{};
+    };
+
+    std::vector<Slot> slots; // Capacity is a power of two, allocated on first insert
+    size_t count = 0;
+    unsigned shift = 32;     // 32 - log2(capacity), so the hash keeps its top bits
+
+    size_t home(Ident key) const { return static_cast<uint32_t>(key * 0x9E3779B9u) >> shift; }
+    size_t mask() const { return slots.size() - 1; }
+
+    void grow() {
+        std::vector<Slot> old = std::move(slots);
+        size_t capacity = old.empty() ? FIRST_CAPACITY : old.size() * 2;
+        slots = std::vector<Slot>(capacity);
+        shift = 32;
+        for (size_t c = capacity; c > 1; c >>= 1) shift--;
+        for (Slot& slot : old) {
+            if (slot.key == NO_IDENT) continue;
+            size_t i = home(slot.key);
+            while (slots[i].key != NO_IDENT) i = (i + 1) & mask();
+            slots[i] = std::move(slot);
+        }
+    }
+};
+
+#endif // IDENT_MAP_HPP
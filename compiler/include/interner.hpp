@@ -0,0 +1,37 @@
+#ifndef INTERNER_HPP
+#define INTERNER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Compiler-wide identifier ids. Every distinct spelling gets one 32-bit id at lex
+// time, so later phases compare and hash integers instead of strings.
+// Id 0 is always the empty string and doubles as "no name".
+using Ident = uint32_t;
+constexpr Ident NO_IDENT = 0;
+
+class Interner {
+public:
+    static Interner& global();
+
+    Ident intern(std::string_view text);
+    Ident find(std::string_view text) const; // NO_IDENT if the spelling was never interned
+    const std::string& spelling(Ident id) const { return *spellings[id]; }
+    size_t size() const { return spellings.size(); }
+
+private:
+    Interner();
+
+    std::deque<std::string> storage; // deque so the views below never dangle
+    std::vector<const std::string*> spellings;
+    std::unordered_map<std::string_view, Ident> ids;
+};
+
+inline Ident intern(std::string_view text) { return Interner::global().intern(text); }
+inline const std::string& spelling(Ident id) { return Interner::global().spelling(id); }
+
+#endif // INTERNER_HPP
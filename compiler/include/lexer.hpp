@@ -2,43 +2,60 @@
 #define LEXER_HPP
 
 #include "utils.hpp"
+#include "interner.hpp"
+#include "token_list.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
-// THE MASTER LIST: X(EnumName, StringValue)
-// Keywords use their string value, Operators/Literals use a label
-#define TOKEN_LIST(X) \
-    X(KEYWORD_RETURN, "return")   X(KEYWORD_PRINT, "print")     \
-    X(KEYWORD_INT, "int")         X(KEYWORD_STRING, "string")   \
-    X(KEYWORD_IF, "if")           X(KEYWORD_ELSE, "else")       \
-    X(KEYWORD_VOID, "void")       X(KEYWORD_WHILE, "while")     \
-    X(KEYWORD_BOOL, "bool")       X(KEYWORD_CHAR, "char")       \
-    X(KEYWORD_FOR, "for")         X(KEYWORD_CONST, "const")     \
-    X(KEYWORD_STRUCT, "struct")   X(KEYWORD_SWITCH, "switch")   \
-    X(KEYWORD_CASE, "case")       X(KEYWORD_DEFAULT, "default") \
-    X(KEYWORD_ASM, "asm")         X(KEYWORD_ENUM, "enum")       \
-    X(KEYWORD_PUBLIC, "public")   X(KEYWORD_PRIVATE, "private") \
-    X(KEYWORD_EXTERN, "extern")   X(KEYWORD_AUTO, "auto")       \
-    X(KEYWORD_FLOAT, "float")     X(KEYWORD_DOUBLE, "double")   \
-    X(KEYWORD_NAMESPACE, "namespace") \
-    X(IDENTIFIER, "ID")           X(INTEGER_LITERAL, "INT_LIT") \
-    X(STRING_LITERAL, "STR_LIT")  X(TRUE, "true")               \
-    X(FALSE, "false")             X(CHARACTER_LITERAL, "CHAR_LIT") \
-    X(FLOAT_LITERAL, "FLOAT_LIT") X(DOUBLE_LITERAL, "DOUBLE_LIT") \
-    X(EQ, "=")                    X(EQUAL_EQUAL, "==")          \
-    X(BANG_EQUAL, "!=")           X(LESS, "<")                  \
-    X(GREATER, ">")               X(LESS_EQUAL, "<=")           \
-    X(GREATER_EQUAL, ">=")        X(PLUS, "+")                  \
-    X(MINUS, "-")                 X(STAR, "*")                  \
-    X(SLASH, "/")                 X(ADDRESSOF, "&")             \
-    X(BANG, "!")                  X(DOUBLE_COLON, "::")         \
-    X(SEMICOLON, ";")             X(LPAREN, "(")                \
-    X(RPAREN, ")")                X(LBRACE, "{")                \
-    X(RBRACE, "}")                X(LBRACKET, "[")              \
-    X(RBRACKET, "]")              X(DOT, ".")                   \
-    X(COLON, ":")                 X(COMMA, ",")                 \
-    X(END_OF_FILE, "EOF")         X(UNKNOWN, "UNKNOWN")
+// A `#line N "file"` marker left by the preprocessor: the source from `offset` on
+// is line N of `file` (which points into the source buffer, or into the line table when
+// the name had escapes to take out).
+struct LineMarker {
+    uint32_t offset;
+    int line;
+    std::string_view file;
+};
+
+// Offsets at which each line of the source starts, and the preprocessor's line markers.
+// The lexer records them as it passes newlines, line/column are only worked out
+// (binary search) when something actually asks for them. Lines are the ones the
+// markers say, i.e. of the original files, when the source has markers.
+class LineTable {
+public:
+    LineTable() : starts{0} {}
+
+    void addLineStart(uint32_t offset) { starts.push_back(offset); }
+    void addMarker(const LineMarker& marker) { markers.push_back(marker); }
+    void append(const LineTable& next) { // next covers later offsets
+        starts.insert(starts.end(), next.starts.begin() + 1, next.starts.end());
+        markers.insert(markers.end(), next.markers.begin(), next.markers.end());
+        files.insert(files.end(), next.files.begin(), next.files.end());
+    }
+    // Keeps a marker's file name that isn't in the source as written (it had escapes)
+    std::string_view keepFile(std::string name) {
+        files.push_back(std::make_shared<const std::string>(std::move(name)));
+        return *files.back();
+    }
+    int line(uint32_t offset) const;   // 1-based
+    int column(uint32_t offset) const; // 1-based, in bytes
+    std::string_view file(uint32_t offset) const; // Empty before the first marker
+    std::string describe(uint32_t offset) const;  // "line L, column C", plus " in <file>" after a marker
+
+private:
+    std::vector<uint32_t> starts;
+    std::vector<LineMarker> markers;
+    std::vector<std::shared_ptr<const std::string>> files; // See keepFile, shared by appended tables
+
+    int physicalLine(uint32_t offset) const;
+    const LineMarker* markerFor(uint32_t offset) const;
+};
 
+// A token as handed to the parser. Built on the fly from a RawToken, so it is
+// cheap to copy and never stored for long.
 struct Token {
     enum Type {
 #define AS_ENUM(name, str) name,
@@ -47,13 +64,146 @@ struct Token {
     };
 
     Type type;
-    std::string value;
-    int line;
-    int column;
+    std::string_view value; // Slice of the source buffer, no copy
+    uint32_t offset;        // Byte offset of the lexeme in the source
+    Ident ident = NO_IDENT; // Interned spelling, set for identifiers only
+    const LineTable* lines = nullptr;
+
+    // Value of a numeric literal, decoded once by the lexer
+    union Number {
+        uint32_t bits;       // INTEGER_LITERAL, the 32-bit pattern as written
+        float float_value;   // FLOAT_LITERAL
+        double double_value; // DOUBLE_LITERAL
+    } number = {};
 
+    int intValue() const { return static_cast<int>(number.bits); }
+    int line() const { return lines ? lines->line(offset) : 0; }
+    int column() const { return lines ? lines->column(offset) : 0; }
+    std::string where() const { return lines ? lines->describe(offset) : "line 0, column 0"; } // For diagnostics
     std::string typeToString() const;
+    std::string text() const { return std::string(value); } // Owned copy for the AST
+};
+
+// A token in its packed form, 13 bytes of information.
+// Offset/length cover the raw lexeme in the source, quotes included. The payload is
+//  - the interned id of an identifier
+//  - the content length of a string/char literal
+//  - the value of an integer literal, the IEEE bits of a float literal
+//  - the index of a double literal's value in the owner's double pool
+struct RawToken {
+    Token::Type kind;
+    uint32_t offset;
+    uint32_t length;
+    uint32_t payload;
+
+    Token toToken(std::string_view source, const LineTable* lines, const std::vector<double>& doubles) const {
+        Token token{kind, source.substr(offset, length), offset, NO_IDENT, lines};
+        switch (kind) {
+            case Token::IDENTIFIER: token.ident = payload; break;
+            case Token::STRING_LITERAL:
+            case Token::CHARACTER_LITERAL: token.value = source.substr(offset + 1, payload); break;
+            case Token::INTEGER_LITERAL: token.number.bits = payload; break;
+            case Token::FLOAT_LITERAL: std::memcpy(&token.number.float_value, &payload, sizeof(float)); break;
+            case Token::DOUBLE_LITERAL: token.number.double_value = doubles[payload]; break;
+            default: break;
+        }
+        return token;
+    }
+};
+
+// A lexer error held back until its line/column can be worked out (parallel lexing)
+struct LexerDiagnostic {
+    uint32_t offset;
+    std::string message;
 };
 
-std::vector<Token> tokenize(const std::string& sourceCode);
+// Pull-based lexer, every next() scans exactly one token so nothing has to be
+// materialized ahead of the parser. Only the line table grows with the source.
+// The source has to outlive the lexer and every token it produced.
+class Lexer {
+public:
+    explicit Lexer(std::string_view source);
+    // Lexes only [begin, end) as one chunk of a parallel tokenize(). Chunks must start at a
+    // line start outside any literal. Identifiers are left un-interned (payload NO_IDENT),
+    // errors go to `diagnostics`, and END_OF_FILE only comes from the chunk ending the source.
+    Lexer(std::string_view source, size_t begin, size_t end, std::vector<LexerDiagnostic>* diagnostics);
+
+    RawToken next(); // Keeps returning END_OF_FILE once the source is exhausted
+    Token view(const RawToken& raw) const { return raw.toToken(src, &lines, doubles); }
+
+    std::string_view source() const { return src; }
+    const LineTable& lineTable() const { return lines; }
+    LineTable takeLineTable() { return std::move(lines); }
+    std::vector<double> takeDoubles() { return std::move(doubles); }
+    size_t errorCount() const { return errors; } // Reported so far, deferred ones included
+    void suppressDiagnostics() { quiet = true; } // Still counted, just not printed
+
+private:
+    std::string_view src;
+    size_t currentPos = 0;
+    size_t errors = 0;
+    bool quiet = false;
+    LineTable lines;
+    std::vector<double> doubles; // Values of DOUBLE_LITERAL tokens, they don't fit the payload
+    std::vector<LexerDiagnostic>* deferred = nullptr; // Set in chunk mode only
+
+    RawToken lexNumber();
+    bool skipLineMarker();
+    void report(size_t offset, std::string message);
+};
+
+// Whole token stream stored as parallel arrays (kind/offset/length/payload columns).
+class TokenBuffer {
+public:
+    explicit TokenBuffer(std::string_view source = {}) : src(source) {}
+
+    void push(const RawToken& raw) {
+        kinds.push_back(static_cast<uint8_t>(raw.kind));
+        offsets.push_back(raw.offset);
+        lengths.push_back(raw.length);
+        payloads.push_back(raw.payload);
+    }
+    void reserve(size_t count) {
+        kinds.reserve(count);
+        offsets.reserve(count);
+        lengths.reserve(count);
+        payloads.reserve(count);
+    }
+
+    size_t size() const { return kinds.size(); }
+    bool empty() const { return kinds.empty(); }
+    Token::Type kind(size_t i) const { return static_cast<Token::Type>(kinds[i]); }
+    RawToken raw(size_t i) const { return {kind(i), offsets[i], lengths[i], payloads[i]}; }
+    Token view(const RawToken& raw) const { return raw.toToken(src, &lines, doubles); }
+    Token operator[](size_t i) const { return view(raw(i)); }
+    Token back() const { return (*this)[size() - 1]; }
+
+    std::string_view source() const { return src; }
+    const LineTable& lineTable() const { return lines; }
+    void setLineTable(LineTable table) { lines = std::move(table); }
+    LineTable takeLineTable() { return std::move(lines); }
+    std::vector<double>& doublePool() { return doubles; }
+    size_t errorCount() const { return errors; } // Lexer errors reported while filling it
+    void setErrorCount(size_t count) { errors = count; }
+
+private:
+    std::string_view src;
+    std::vector<uint8_t> kinds;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::vector<uint32_t> payloads;
+    std::vector<double> doubles;
+    LineTable lines;
+    size_t errors = 0;
+};
+
+// Lexes the whole source up front. Tokens point into sourceCode, so it has to outlive them.
+// With threads > 1, large sources are split at line starts and the chunks lexed in
+// parallel; the result (token ids, identifier ids, diagnostics) is identical to a serial run.
+TokenBuffer tokenize(std::string_view sourceCode, unsigned threads = 1);
+
+// Chunks smaller than this aren't worth a thread, tokenize() only splits sources of at
+// least twice this size
+constexpr size_t MIN_LEX_CHUNK = 256 * 1024;
 
 #endif
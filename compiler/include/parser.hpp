@@ -7,6 +7,7 @@
 #include <memory>
 #include <string>
 #include <map>
+#include <optional>
 #include <stdexcept>
 #include "ast.hpp"
 #include "symbol_table.hpp"
@@ -14,56 +15,119 @@
 // Parser class handles syntax analysis and AST construction
 class Parser {
 public:
-    Parser(std::vector<Token> tokens);
+    explicit Parser(Lexer lexer);
+    // Pre-lexed, e.g. by a parallel tokenize(). With threads > 1, big enough sources
+    // have their top-level function bodies parsed on that many threads.
+    explicit Parser(TokenBuffer tokens, unsigned threads = 1);
     std::unique_ptr<ProgramNode> parse();
+    // Streaming compilation (-stream) runs two parsers over the source: one for
+    // parseDeclarations(), then one handing out the functions via parseNextFunction()
+    std::unique_ptr<ProgramNode> parseDeclarations();
+    NodePtr<FunctionDefinitionNode> parseNextFunction(ASTArena& function_arena);
     SymbolTable& getSymbolTable() { return symbol_table; }
+    // Line starts and markers the lexer recorded, for the SourceManager once parsing is done
+    LineTable takeLineTable() { return owned_tokens ? owned_tokens->takeLineTable() : lexer.takeLineTable(); }
+    // Lexer errors don't stop the parse, the caller fails the compile once it's done
+    size_t errorCount() const { return owned_tokens ? owned_tokens->errorCount() : lexer.errorCount(); }
+    // Errors and warnings printed while lexing and parsing
+    size_t diagnosticCount() const { return errorCount() + warnings; }
+    // For a second pass over a source another parser has already reported on
+    void suppressDiagnostics() { quiet = true; lexer.suppressDiagnostics(); }
 
 private:
-    std::vector<Token> tokens;
-    size_t current_token_index;
+    // Tokens are pulled from the lexer on demand and live only in this ring until consumed
+    static constexpr size_t LOOKAHEAD = 8; // Power of two, peek() needs at most 5
+    Lexer lexer;
+    std::optional<TokenBuffer> owned_tokens;
+    const TokenBuffer* buffered = nullptr; // Replaces the lexer when the tokens were lexed up front
+    size_t buffered_index = 0;
+    RawToken lookahead[LOOKAHEAD];
+    size_t lookahead_head = 0;
+    size_t lookahead_count = 0;
+    bool reached_end = false;
+    size_t warnings = 0;
+    bool quiet = false;
+
+    // Nodes are allocated in the arena of the ProgramNode being built
+    ASTArena* arena = nullptr;
+    template <typename T, typename... Args>
+    NodePtr<T> newNode(Args&&... args) { return arena->make<T>(std::forward<Args>(args)...); }
+    // Scratch stacks for parseBinaryExpression and parseUnaryExpression, reused across expressions
+    std::vector<NodePtr<ASTNode>> operand_stack;
+    std::vector<Token> operator_stack;
     std::map<std::string, int> declared_variables;
     SymbolTable symbol_table; // Add SymbolTable member
 
+    // Parallel parsing of top-level function bodies, see parseParallel()
+    struct BodyJob {
+        FunctionDefinitionNode* function;
+        size_t begin; // First token after the '{'
+        size_t end;   // The matching '}'
+    };
+    unsigned parse_threads = 1;
+    std::vector<std::pair<size_t, size_t>> top_level_braces; // Token indices of every top-level '{' and its '}'
+    std::vector<BodyJob>* deferred_bodies = nullptr; // Set during the serial pass of parseParallel
+    bool skip_top_level_bodies = false; // Set during parseDeclarations
+
+    Parser(const TokenBuffer& tokens, ASTArena& worker_arena); // Worker over another parser's tokens
+    std::unique_ptr<ProgramNode> parseParallel();
+    void findTopLevelBraces();
+    void parseBody(size_t begin, std::vector<NodePtr<ASTNode>>& body);
+    void skipBody();
+    void seek(size_t index);
+    size_t position() const { return buffered_index - lookahead_count; } // Index of the token peek() returns
+
     // Token handling methods
-    const Token& peek(size_t offset = 0) const;
-    const Token& consume();
+    Token peek(size_t offset = 0);
+    Token consume();
+    RawToken pullToken();
+    Token view(const RawToken& raw) const { return buffered ? buffered->view(raw) : lexer.view(raw); }
     void expect(Token::Type expected_type, const std::string& error_msg);
     bool match(Token::Type type);
+    bool atWord(std::string_view word, size_t offset = 0); // An identifier spelled `word`
+    bool matchWord(std::string_view word);
+    bool atAlignmentPrefix();
 
-    std::unique_ptr<ASTNode> parseStatement(); // General statement parsing (e.g., return, var decl, assignment)
-    std::unique_ptr<VariableDeclarationNode> parseVariableDeclaration();
-    std::unique_ptr<VariableAssignmentNode> parseVariableAssignment();
-    std::unique_ptr<VariableReferenceNode> parseVariableReference();
-    std::unique_ptr<ReturnStatementNode> parseReturnStatement();
-    std::unique_ptr<PrintStatementNode> parsePrintStatement();
-    std::unique_ptr<IfStatementNode> parseIfStatement();
-    std::unique_ptr<WhileStatementNode> parseWhileStatement();
-    std::unique_ptr<ForStatementNode> parseForStatement();
-    std::unique_ptr<FunctionCallNode> parseFunctionCall();
+    bool atFunctionDefinition();
+    void parseTopLevel(ProgramNode& program);
+    void parseTopLevelDeclaration(ProgramNode& program); // Any top-level item but a function
+    NodePtr<ASTNode> parseStatement(); // General statement parsing (e.g., return, var decl, assignment)
+    NodePtr<VariableDeclarationNode> parseVariableDeclaration();
+    NodePtr<VariableAssignmentNode> parseVariableAssignment();
+    NodePtr<VariableReferenceNode> parseVariableReference();
+    NodePtr<ReturnStatementNode> parseReturnStatement();
+    NodePtr<PrintStatementNode> parsePrintStatement();
+    NodePtr<IfStatementNode> parseIfStatement();
+    NodePtr<WhileStatementNode> parseWhileStatement();
+    NodePtr<ForStatementNode> parseForStatement();
+    NodePtr<FunctionCallNode> parseFunctionCall();
     std::vector<std::unique_ptr<ParameterNode>> parseParameters();
-    std::unique_ptr<TypeNode> parseType();
-    std::unique_ptr<StructDefinitionNode> parseStructDefinition();
-    std::unique_ptr<AsmStatementNode> parseAsmStatement();
-    std::unique_ptr<ConstantDeclarationNode> parseConstantDeclaration();
-    std::unique_ptr<EnumStatementNode> parseEnumStatement();
-    std::unique_ptr<SwitchStatementNode> parseSwitchStatement();
-    std::unique_ptr<NamespaceDefinition> parseNamespaceDefinition();
+    const TypeNode* parseType();
+    NodePtr<StructDefinitionNode> parseStructDefinition();
+    int parseAlignment(); // align(N), N a power of two
+    NodePtr<AsmStatementNode> parseAsmStatement();
+    NodePtr<ConstantDeclarationNode> parseConstantDeclaration();
+    NodePtr<EnumStatementNode> parseEnumStatement();
+    NodePtr<SwitchStatementNode> parseSwitchStatement();
+    NodePtr<NamespaceDefinition> parseNamespaceDefinition();
 
-    // Expression parsing methods (now hierarchical for precedence)
-    std::unique_ptr<ASTNode> parseExpression(); 		// Handles + and - (lowest precedence)
-    std::unique_ptr<ASTNode> parseComparisonExpression(); 	// Handles == and > or < and <= or >= 
-    std::unique_ptr<ASTNode> parseTerm();       		// Handles * and / (medium precedence)
-    std::unique_ptr<ASTNode> parseFactor();     		// Handles literals, variables, and parentheses (highest precedence)
-    std::unique_ptr<ASTNode> parseAdditiveExpression();
-    std::unique_ptr<ASTNode> parseUnaryExpression();
+    // Expression parsing methods (table-driven precedence climbing)
+    NodePtr<ASTNode> parseExpression(); 		// Handles assignment (lowest precedence, right associative)
+    NodePtr<ASTNode> parseBinaryExpression(); 	// All binary operators, precedence from BINARY_PRECEDENCE
+    NodePtr<ASTNode> parseUnaryExpression(); 	// Prefix *, & and !
+    NodePtr<ASTNode> parsePostfixExpression(); 	// Member access and array indexing
+    NodePtr<ASTNode> parsePrimaryExpression(); 	// Literals, names, calls, ns::member and parentheses
 
-    std::unique_ptr<IntegerLiteralExpressionNode> parseIntegerLiteralExpression(); // Specific helper for int literals
-    std::unique_ptr<FloatLiteralExpressionNode> parseFloatLiteralExpression();
-    std::unique_ptr<DoubleLiteralExpressionNode> parseDoubleLiteralExpression();
-    std::unique_ptr<StringLiteralExpressionNode> parseStringLiteralExpression();
-    std::unique_ptr<BooleanLiteralExpressionNode> parseBooleanLiteralExpression();
-    std::unique_ptr<CharacterLiteralExpressionNode> parseCharacterLiteralExpression();
-    std::unique_ptr<FunctionDefinitionNode> parseFunctionDefinition();
+    NodePtr<IntegerLiteralExpressionNode> parseIntegerLiteralExpression(); // Specific helper for int literals
+    NodePtr<FloatLiteralExpressionNode> parseFloatLiteralExpression();
+    NodePtr<DoubleLiteralExpressionNode> parseDoubleLiteralExpression();
+    NodePtr<StringLiteralExpressionNode> parseStringLiteralExpression();
+    NodePtr<BooleanLiteralExpressionNode> parseBooleanLiteralExpression();
+    NodePtr<CharacterLiteralExpressionNode> parseCharacterLiteralExpression();
+    NodePtr<FunctionDefinitionNode> parseFunctionDefinition(bool skip_body = false);
 };
 
+// Sources with fewer tokens than this are parsed serially even when threads are available
+constexpr size_t MIN_PARALLEL_PARSE_TOKENS = 64 * 1024;
+
 #endif // NYTROGEN_PARSER_HPP
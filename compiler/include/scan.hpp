@@ -0,0 +1,28 @@
+#ifndef SCAN_HPP
+#define SCAN_HPP
+
+#include <cstddef>
+#include <string_view>
+
+class LineTable;
+
+// Bulk scanning kernels used by the lexer.
+// Each one consumes a run of bytes 16 (SSE2) or 32 (AVX2) at a time and falls back to a
+// plain loop for the tail of the buffer or when neither instruction set is available.
+// Newlines are taken from the same compare masks and recorded in the LineTable,
+// one entry per set bit, so line tracking costs nothing per byte.
+// All classification is ASCII only, the lexer never depended on the C locale anyway.
+
+// Skips spaces, tabs, newlines, \v, \f and \r starting at pos. Returns the first non-whitespace position.
+size_t skipWhitespace(std::string_view src, size_t pos, LineTable& lines);
+
+// Returns the position of the next '\n' (or src.size()), used to skip // comments.
+size_t findLineEnd(std::string_view src, size_t pos);
+
+// Returns the position of the next '"' (or src.size()), recording any newlines in the body.
+size_t findStringEnd(std::string_view src, size_t pos, LineTable& lines);
+
+// Returns the end of the [A-Za-z0-9_] run starting at pos.
+size_t scanIdentifier(std::string_view src, size_t pos);
+
+#endif // SCAN_HPP
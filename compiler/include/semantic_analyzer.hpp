@@ -8,15 +8,22 @@
 #include <map>
 #include "ast.hpp"
 #include "symbol_table.hpp"
+#include "type_layout.hpp"
+
+class SemanticAnalyzer : public ASTVisitor<SemanticAnalyzer> {
+    friend class ASTVisitor<SemanticAnalyzer>;
 
-class SemanticAnalyzer {
 public:
     SemanticAnalyzer(std::unique_ptr<ProgramNode>& ast, SymbolTable& symTable)
         : program_ast(ast), symbolTable(symTable) {}
 
     void analyze();
+    // analyze() in steps, for streaming compilation: the declarations (structs, function
+    // signatures, globals) first, then one function at a time once its body is parsed
+    void analyzeDeclarations();
+    void analyzeFunction(FunctionDefinitionNode* func_node);
+    void checkEntryPoint();
     SymbolTable& getSymbolTable() { return symbolTable; }
-    int getTypeSize(const TypeNode* type); // Helper to get size of a type
     bool areTypesCompatible(const TypeNode* type1, const TypeNode* type2);
 
     void setIsEntryPoint(bool entry) { is_entry_point = entry; }
@@ -27,8 +34,11 @@ private:
     std::unique_ptr<ProgramNode>& program_ast;
     SymbolTable& symbolTable;
     std::string typeToString(const TypeNode* type);
-    TypeNode* currentFunctionReturnType = nullptr;
-    std::vector<std::string> namespace_stack;
+    const TypeNode* currentFunctionReturnType = nullptr;
+    std::vector<Ident> namespace_stack;
+    bool error_located = false; // The error being thrown already has its position
+    template <typename Run>
+    auto locateErrors(ASTNode* node, Run&& run) -> decltype(run());
 
     // Visitor methods for AST nodes
     void visit(ASTNode* node);
@@ -54,15 +64,57 @@ private:
     void visit(EnumStatementNode* node);
     void visit(SwitchStatementNode* node);
     void visit(ScopeResolutionNode* node);
+    void visit(IntegerLiteralExpressionNode* node);
+    void visit(StringLiteralExpressionNode* node);
+    void visit(BooleanLiteralExpressionNode* node);
+    void visit(CharacterLiteralExpressionNode* node);
+    void visit(FloatLiteralExpressionNode* node);
+    void visit(DoubleLiteralExpressionNode* node);
+
+    // Analyzes an expression and returns its type, also stored in its resolved_type
+    const TypeNode* visitExpression(ASTNode* expr);
+
+    // What visitExpression() dispatches through: a second visitor whose visits return the
+    // expression's type. It has an overload for every node kind too, so a new kind doesn't
+    // compile until it's handled here as well. Kinds that aren't expressions throw.
+    class ExpressionVisitor : public ASTVisitor<ExpressionVisitor, const TypeNode*> {
+    public:
+        explicit ExpressionVisitor(SemanticAnalyzer& analyzer) : analyzer(analyzer) {}
+
+        const TypeNode* visit(IntegerLiteralExpressionNode* node);
+        const TypeNode* visit(StringLiteralExpressionNode* node);
+        const TypeNode* visit(BooleanLiteralExpressionNode* node);
+        const TypeNode* visit(CharacterLiteralExpressionNode* node);
+        const TypeNode* visit(FloatLiteralExpressionNode* node);
+        const TypeNode* visit(DoubleLiteralExpressionNode* node);
+        const TypeNode* visit(VariableReferenceNode* node);
+        const TypeNode* visit(BinaryOperationExpressionNode* node);
+        const TypeNode* visit(FunctionCallNode* node);
+        const TypeNode* visit(MemberAccessNode* node);
+        const TypeNode* visit(UnaryOpExpressionNode* node);
+        const TypeNode* visit(ArrayAccessNode* node);
+        const TypeNode* visit(VariableAssignmentNode* node);
+        const TypeNode* visit(VariableDeclarationNode* node);
+        const TypeNode* visit(ScopeResolutionNode* node);
+
+        const TypeNode* visit(ProgramNode* node);
+        const TypeNode* visit(FunctionDefinitionNode* node);
+        const TypeNode* visit(PrintStatementNode* node);
+        const TypeNode* visit(ReturnStatementNode* node);
+        const TypeNode* visit(IfStatementNode* node);
+        const TypeNode* visit(WhileStatementNode* node);
+        const TypeNode* visit(ForStatementNode* node);
+        const TypeNode* visit(StructDefinitionNode* node);
+        const TypeNode* visit(NamespaceDefinition* node);
+        const TypeNode* visit(AsmStatementNode* node);
+        const TypeNode* visit(ConstantDeclarationNode* node);
+        const TypeNode* visit(EnumStatementNode* node);
+        const TypeNode* visit(SwitchStatementNode* node);
 
-    // Expression visitors (return the type of the expression)
-    std::unique_ptr<TypeNode> visitExpression(ASTNode* expr);
-    std::unique_ptr<TypeNode> visitIntegerLiteralExpression(IntegerLiteralExpressionNode* node);
-    std::unique_ptr<TypeNode> visitStringLiteralExpression(StringLiteralExpressionNode* node);
-    std::unique_ptr<TypeNode> visitBooleanLiteralExpression(BooleanLiteralExpressionNode* node);
-    std::unique_ptr<TypeNode> visitCharacterLiteralExpression(CharacterLiteralExpressionNode* node);
-    std::unique_ptr<TypeNode> visitFloatLiteralExpression(FloatLiteralExpressionNode* node);
-    std::unique_ptr<TypeNode> visitDoubleLiteralExpression(DoubleLiteralExpressionNode* node);
+    private:
+        SemanticAnalyzer& analyzer;
+        [[noreturn]] static const TypeNode* notAnExpression(ASTNode* node);
+    };
 };
 
 #endif // SEMANTIC_ANALYZER_HPP
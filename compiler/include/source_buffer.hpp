@@ -0,0 +1,37 @@
+#ifndef SOURCE_BUFFER_HPP
+#define SOURCE_BUFFER_HPP
+
+#include <string>
+#include <string_view>
+
+// Read-only view of a source file.
+// The file is memory-mapped when possible so the lexer can hand out tokens that
+// point straight into the mapping instead of copying every lexeme. Falls back to
+// reading the file into an owned string for things mmap can't handle (pipes, etc).
+// Tokens produced from a SourceBuffer are only valid while the buffer is alive.
+class SourceBuffer {
+public:
+    SourceBuffer() = default;
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    bool open(const std::string& filepath);
+
+    std::string_view text() const { return std::string_view(data, length); }
+    const std::string& path() const { return filepath; }
+    bool empty() const { return length == 0; }
+    bool isMapped() const { return mapped; }
+
+private:
+    std::string filepath;
+    const char* data = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    std::string fallback; // Only used when the file couldn't be mapped
+
+    void release();
+};
+
+#endif // SOURCE_BUFFER_HPP
@@ -0,0 +1,46 @@
+#ifndef SOURCE_MANAGER_HPP
+#define SOURCE_MANAGER_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "lexer.hpp"
+
+// Compiler-wide source positions. A SourceLoc is a byte offset into the preprocessed
+// unit, which holds the main file and everything it included back to back, so one
+// 32-bit number covers every file. The preprocessor's #line markers say which file and
+// line each stretch came from. File/line/column are only worked out (binary search over
+// the line table) when a diagnostic or a dump asks for them.
+using SourceLoc = uint32_t;
+constexpr SourceLoc NO_LOC = UINT32_MAX;
+
+struct PresumedLoc {
+    std::string_view file; // Original file, the unit's own path before any marker
+    int line = 0;          // 0 for NO_LOC
+    int column = 0;
+};
+
+class SourceManager {
+public:
+    static SourceManager& global();
+
+    // The unit being compiled. Both have to outlive every lookup. Without a line table
+    // (AST cache hit) one is built by lexing the text again on the first lookup.
+    void setUnit(std::string path, std::string_view text);
+    void setLineTable(LineTable table) { lines = std::move(table); }
+
+    PresumedLoc presumed(SourceLoc loc);
+    std::string describe(SourceLoc loc); // "file:line:column"
+
+private:
+    SourceManager() = default;
+
+    std::string path;
+    std::string_view text;
+    std::optional<LineTable> lines;
+
+    const LineTable& lineTable();
+};
+
+#endif // SOURCE_MANAGER_HPP
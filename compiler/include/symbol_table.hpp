@@ -4,25 +4,22 @@
 #include "utils.hpp"
 #include <string>
 #include <vector>
-#include <map>
+#include <deque>
+#include <cstdint>
 #include <memory>
 #include <iostream> // For std::cerr and std::endl
 #include <ostream>  // For std::endl
 #include "ast.hpp" // For TypeNode and other AST types
-
-// Forward declaration for StructDefinitionNode if needed, though ast.hpp should include it
-struct EnumStatementNode;
+#include "ident_map.hpp"
 
 class Scope;
 
-struct EnumInfo {
-    std::string name;
-    std::shared_ptr<EnumStatementNode> node; // The AST node for the enum
-};
-
-// Represents information about a single symbol (variable, function, struct member)
+// The part every symbol has: what name lookup, type checking and the AST need. Whatever
+// only one kind of symbol carries lives in that kind's record, in a pool owned by the
+// SymbolTable, and `index` says which record. Symbols are 24 bytes and stay put, the AST
+// points at them.
 struct Symbol {
-    enum class SymbolType {
+    enum class SymbolType : uint8_t {
         VARIABLE,
         FUNCTION,
         STRUCT_DEFINITION,
@@ -34,69 +31,43 @@ struct Symbol {
     };
 
     SymbolType type;
-    std::string name;
-    std::string mangled_name;
-    std::string is_global;
-    std::unique_ptr<TypeNode> dataType;
-    std::shared_ptr<StructDefinitionNode> structDef;
-    int offset;
-    int size;
-    std::unique_ptr<ASTNode> value; // For constants
-    std::shared_ptr<EnumInfo> enumInfo; // For enum types
-    StructMember::Visibility visibility; // For struct members
-
-    Scope* internal_scope = nullptr; 
-
-    SymbolTable* get_scope() { return (SymbolTable*)internal_scope; } 
-
-    // Constructor for namespaces
-    Symbol(SymbolType type, std::string name, Scope* scope)
-        : type(type), name(std::move(name)), dataType(nullptr), 
-          internal_scope(scope), offset(0), size(0), visibility(StructMember::Visibility::PUBLIC) {}
-
-    // Constructor for variables/members
-    Symbol(SymbolType type, std::string name, std::unique_ptr<TypeNode> dataType, int offset = 0, int size = 0, StructMember::Visibility visibility = StructMember::Visibility::PUBLIC)
-        : type(type), name(std::move(name)), dataType(std::move(dataType)), structDef(nullptr), offset(offset), size(size), value(nullptr), enumInfo(nullptr), visibility(visibility) {}
-
-    // Constructor for functions
-    Symbol(SymbolType type, std::string name, std::unique_ptr<TypeNode> dataType, std::vector<std::unique_ptr<TypeNode>> paramTypes)
-        : type(type), name(std::move(name)), dataType(std::move(dataType)), structDef(nullptr), parameterTypes(std::move(paramTypes)), offset(0), size(0), value(nullptr), enumInfo(nullptr), visibility(StructMember::Visibility::PUBLIC) {}
-
-    // Constructor for struct definitions
-    Symbol(SymbolType type, std::string name, std::shared_ptr<StructDefinitionNode> structDef)
-        : type(type), name(std::move(name)), dataType(nullptr), structDef(std::move(structDef)), offset(0), size(structDef->size), value(nullptr), enumInfo(nullptr), visibility(StructMember::Visibility::PUBLIC) {}
+    Ident name;
+    const TypeNode* dataType = nullptr; // Variable or constant type, function return type
+    int offset = 0;                     // Frame offset of a local or parameter, offset of a member
+    uint32_t index = 0;                 // Record in the pool for this kind, if it has one
+};
 
-    // Constructor for constants
-    Symbol(SymbolType type, std::string name, std::unique_ptr<TypeNode> dataType, std::unique_ptr<ASTNode> value)
-        : type(type), name(std::move(name)), dataType(std::move(dataType)), structDef(nullptr), offset(0), size(0), value(std::move(value)), enumInfo(nullptr), visibility(StructMember::Visibility::PUBLIC) {}
+// Per-kind records
+struct VariableRecord {
+    Ident label; // Data label of a declared variable, NO_IDENT for parameters (on the stack)
+};
 
-    // Constructor for enum types
-    Symbol(SymbolType type, std::string name, std::shared_ptr<EnumInfo> enumInfo)
-        : type(type), name(std::move(name)), dataType(nullptr), structDef(nullptr), offset(0), size(0), value(nullptr), enumInfo(std::move(enumInfo)), visibility(StructMember::Visibility::PUBLIC) {}
+struct FunctionRecord {
+    Ident label;             // Mangled name to call
+    uint32_t first_param;    // Range in SymbolTable::parameter_types
+    uint32_t param_count;
+};
 
+struct ConstantRecord {
+    NodePtr<ASTNode> value; // Literal the constant stands for
+};
 
-    std::vector<std::unique_ptr<TypeNode>> parameterTypes; // For functions: types of parameters
+struct NamespaceRecord {
+    Scope* scope;
 };
 
 // Represents a single scope in the symbol table (e.g., global, function body)
 class Scope {
 public:
-    std::map<std::string, Symbol> symbols;
+    IdentMap<Symbol*> symbols;
     int currentOffset; // For local variables, tracks the current stack offset
     Scope* parent;
 
     Scope(Scope* p = nullptr) : currentOffset(0), parent(p) {}
 
-    void addSymbol(Symbol&& symbol) {
-        symbols.emplace(symbol.name, std::move(symbol));
-    }
-
-    Symbol* lookup(const std::string& name) {
-        auto it = symbols.find(name);
-        if (it != symbols.end()) {
-            return &it->second;
-        }
-        return nullptr;
+    Symbol* lookup(Ident name) {
+        Symbol** found = symbols.find(name);
+        return found ? *found : nullptr;
     }
 };
 
@@ -109,8 +80,6 @@ public:
 
     Scope* current_scope;
 
-    std::map<std::string, StructDefinitionNode*> struct_definitions;
-
     SymbolTable() : current_scope(nullptr) {
         enterScope(); // Creates the Global Scope
     }
@@ -134,23 +103,97 @@ public:
         }
     }
 
-    Symbol* addSymbol(Symbol&& symbol) {
-        if (current_scope) {
-	    if (debug_mode) std::cerr << "Debug: Adding symbol '" << symbol.name << "' to current scope." << std::endl;
-            auto result = current_scope->symbols.emplace(symbol.name, std::move(symbol));
-            return &(result.first->second);
-        }
-        return nullptr;
+    // How full the archive and the pools are, see releaseScopes
+    struct Mark {
+        size_t scopes, symbols, variables, functions, parameters, constants, namespaces;
+    };
+
+    Mark mark() const {
+        return {all_scopes.size(), symbols.size(), variables.size(), functions.size(),
+                parameter_types.size(), constants.size(), namespaces.size()};
+    }
+
+    // Drops the scopes entered and the symbols made since `mark`. Only for scopes nothing
+    // points into anymore, i.e. a function that has been analyzed and generated.
+    void releaseScopes(const Mark& mark) {
+        if (mark.scopes < all_scopes.size()) all_scopes.resize(mark.scopes);
+        symbols.resize(mark.symbols);
+        variables.resize(mark.variables);
+        functions.resize(mark.functions);
+        parameter_types.resize(mark.parameters);
+        constants.resize(mark.constants);
+        namespaces.resize(mark.namespaces);
+        if (debug_mode) std::cerr << "Debug: Released scopes. Total scopes in archive: " << all_scopes.size() << std::endl;
+    }
+
+    // The add* functions declare a symbol in the current scope. Like a map insert they
+    // keep an existing symbol of the same name in that scope and return it instead.
+    Symbol* addVariable(Ident name, const TypeNode* type, int offset, Ident label = NO_IDENT) {
+        if (Symbol* existing = lookupShallow(name)) return existing;
+        Symbol* symbol = newSymbol(Symbol::SymbolType::VARIABLE, name, type, offset, variables.size());
+        variables.push_back({label});
+        return declare(current_scope, symbol);
+    }
+
+    Symbol* addFunction(const FunctionDefinitionNode& node, Ident label) {
+        if (Symbol* existing = lookupShallow(node.name)) return existing;
+        Symbol* symbol = newSymbol(Symbol::SymbolType::FUNCTION, node.name, node.return_type, 0, functions.size());
+        functions.push_back({label, static_cast<uint32_t>(parameter_types.size()), static_cast<uint32_t>(node.parameters.size())});
+        for (const auto& param : node.parameters) parameter_types.push_back(param->type);
+        return declare(current_scope, symbol);
+    }
+
+    Symbol* addConstant(Ident name, const TypeNode* type, NodePtr<ASTNode> value) {
+        if (Symbol* existing = lookupShallow(name)) return existing;
+        Symbol* symbol = newSymbol(Symbol::SymbolType::CONSTANT, name, type, 0, constants.size());
+        constants.push_back({std::move(value)});
+        return declare(current_scope, symbol);
+    }
+
+    Symbol* addEnum(Ident name) {
+        if (Symbol* existing = lookupShallow(name)) return existing;
+        return declare(current_scope, newSymbol(Symbol::SymbolType::ENUM_TYPE, name, nullptr, 0, 0));
     }
 
-    Symbol* lookupShallow(const std::string& name) {
+    // Declared in the scope around the namespace's own scope
+    Symbol* addNamespace(Ident name, Scope* scope) {
+        if (Symbol* existing = scope->parent->lookup(name)) return existing;
+        Symbol* symbol = newSymbol(Symbol::SymbolType::NAMESPACE_DEFINITION, name, nullptr, 0, namespaces.size());
+        namespaces.push_back({scope});
+        return declare(scope->parent, symbol);
+    }
+
+    // Struct members are reached through their struct, not by name, so they go in no scope
+    Symbol* addMember(const StructMember& member) {
+        return newSymbol(Symbol::SymbolType::STRUCT_MEMBER, member.name, member.type, member.offset, 0);
+    }
+
+    // Record lookups, only valid for a symbol of the matching kind
+    const VariableRecord& variable(const Symbol& symbol) const { return variables[symbol.index]; }
+    const FunctionRecord& function(const Symbol& symbol) const { return functions[symbol.index]; }
+    const ConstantRecord& constant(const Symbol& symbol) const { return constants[symbol.index]; }
+    const NamespaceRecord& namespaceRecord(const Symbol& symbol) const { return namespaces[symbol.index]; }
+
+    // Assembly label of a variable with static storage or of a function, NO_IDENT for
+    // anything else
+    Ident label(const Symbol& symbol) const {
+        if (symbol.type == Symbol::SymbolType::VARIABLE) return variables[symbol.index].label;
+        if (symbol.type == Symbol::SymbolType::FUNCTION) return functions[symbol.index].label;
+        return NO_IDENT;
+    }
+
+    const TypeNode* parameterType(const Symbol& function_symbol, size_t i) const {
+        return parameter_types[function(function_symbol).first_param + i];
+    }
+
+    Symbol* lookupShallow(Ident name) {
         if (current_scope) {
             return current_scope->lookup(name);
         }
         return nullptr;
     }
 
-    Symbol* lookup(const std::string& name) {
+    Symbol* lookup(Ident name) {
         Scope* search_head = current_scope;
         while (search_head != nullptr) {
             if (Symbol* symbol = search_head->lookup(name)) {
@@ -161,16 +204,25 @@ public:
         return nullptr;
     }
 
-    bool isStructDefined(const std::string& name) {
-        return struct_definitions.count(name) > 0;
-    }
-
-    void addStructDefinition(const std::string& name, StructDefinitionNode* node) {
-        struct_definitions[name] = node;
+private:
+    // Symbols are pointed to by the AST, so their pool is a deque: it never moves what it
+    // holds. The records are only reached by index and sit in plain vectors.
+    std::deque<Symbol> symbols;
+    std::vector<VariableRecord> variables;
+    std::vector<FunctionRecord> functions;
+    std::vector<const TypeNode*> parameter_types; // Every function's, back to back
+    std::vector<ConstantRecord> constants;
+    std::vector<NamespaceRecord> namespaces;
+
+    Symbol* newSymbol(Symbol::SymbolType type, Ident name, const TypeNode* dataType, int offset, size_t index) {
+        symbols.push_back({type, name, dataType, offset, static_cast<uint32_t>(index)});
+        return &symbols.back();
     }
 
-    std::map<std::string, StructDefinitionNode*> getStructDefinitions() {
-        return struct_definitions;
+    Symbol* declare(Scope* scope, Symbol* symbol) {
+        if (debug_mode) std::cerr << "Debug: Adding symbol '" << spelling(symbol->name) << "' to current scope." << std::endl;
+        scope->symbols.emplace(symbol->name, symbol);
+        return symbol;
     }
 };
 
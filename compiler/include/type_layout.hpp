@@ -0,0 +1,49 @@
+#ifndef TYPE_LAYOUT_HPP
+#define TYPE_LAYOUT_HPP
+
+#include <vector>
+#include "types.hpp"
+
+struct StructDefinitionNode;
+
+struct TypeLayout {
+    int size = 0;
+    int align = 0; // 0 until computed, every laid out type aligns to at least 1
+};
+
+// Size and alignment of every type, shared by the semantic analyzer and the code
+// generator. Types are canonical, so a layout is computed the first time a type is
+// asked about and kept in a table indexed by TypeNode::id; after that a query is one
+// array read. Struct members are given their offsets here as well, once per definition.
+// Throws std::runtime_error for a type that has no layout (an undefined struct, an
+// unsized array); nothing is cached for those.
+class LayoutTable {
+public:
+    static LayoutTable& global();
+
+    const TypeLayout& layout(const TypeNode* type);
+    int sizeOf(const TypeNode* type) { return layout(type).size; }
+    int alignOf(const TypeNode* type) { return layout(type).align; }
+
+    // Sets the members' offsets and the struct's size and alignment, and binds the
+    // struct's type to the definition. Every member type has to have a layout already.
+    // By default members get their natural alignment, with padding in between and at the
+    // end; `packed` drops the padding, `reorder` places the members by decreasing
+    // alignment and `align(N)` raises the struct's alignment to N.
+    void layoutStruct(StructDefinitionNode& definition);
+
+private:
+    LayoutTable() = default;
+
+    std::vector<TypeLayout> layouts; // By TypeNode::id, grown as new types show up
+
+    TypeLayout compute(const TypeNode* type);
+};
+
+inline int typeSize(const TypeNode* type) { return LayoutTable::global().sizeOf(type); }
+inline int typeAlign(const TypeNode* type) { return LayoutTable::global().alignOf(type); }
+
+// Rounds offset up to a multiple of align, a power of two
+inline int alignUp(int offset, int align) { return (offset + align - 1) & ~(align - 1); }
+
+#endif // TYPE_LAYOUT_HPP
@@ -0,0 +1,130 @@
+#ifndef TYPES_HPP
+#define TYPES_HPP
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "lexer.hpp"
+
+// Type representations. Every type is built once by the TypeContext and shared
+// from then on, so two types are the same type exactly when their pointers are
+// equal, and the rest of the compiler passes them around as const TypeNode*.
+
+// Base class for type representations
+struct TypeNode {
+    enum class TypeCategory {
+        PRIMITIVE,
+        POINTER,
+        ARRAY,
+        STRUCT
+    };
+    TypeCategory category;
+    uint32_t id = 0; // Dense index given by the TypeContext, for tables keyed by type
+    TypeNode(TypeCategory cat) : category(cat) {}
+    virtual ~TypeNode() = default;
+    virtual std::string typeName() const = 0;
+};
+
+struct PrimitiveTypeNode : public TypeNode {
+    Token::Type primitive_type;
+    PrimitiveTypeNode(Token::Type type) : TypeNode(TypeCategory::PRIMITIVE), primitive_type(type) {}
+
+    std::string typeName() const override {
+        switch(primitive_type) {
+            case Token::KEYWORD_INT:    return "int";
+            case Token::KEYWORD_FLOAT:  return "float";
+            case Token::KEYWORD_DOUBLE: return "double";
+            case Token::KEYWORD_STRING: return "string";
+            case Token::KEYWORD_BOOL:   return "bool";
+            default: return "unknown_primitive";
+        }
+    }
+};
+
+struct PointerTypeNode : public TypeNode {
+    const TypeNode* base_type;
+    PointerTypeNode(const TypeNode* base) : TypeNode(TypeCategory::POINTER), base_type(base) {}
+    std::string typeName() const override {
+        return base_type->typeName() + "*";
+    }
+};
+
+struct ArrayTypeNode : public TypeNode {
+    const TypeNode* base_type;
+    int size;
+
+    ArrayTypeNode(const TypeNode* base, int sz) : TypeNode(TypeCategory::ARRAY), base_type(base), size(sz) {}
+    std::string typeName() const override {
+        return base_type->typeName() + "[" + std::to_string(size) + "]";
+    }
+};
+
+struct StructDefinitionNode;
+
+struct StructTypeNode : public TypeNode {
+    std::string struct_name;
+    // Bound once by the semantic analyzer when it reaches the definition, later lookups of
+    // the struct go through here instead of by name. Null for a struct never defined.
+    mutable const StructDefinitionNode* definition = nullptr;
+    StructTypeNode(std::string name) : TypeNode(TypeCategory::STRUCT), struct_name(std::move(name)) {}
+    std::string typeName() const override {
+        return "struct " + struct_name;
+    }
+};
+
+struct AutoTypeNode : public TypeNode {
+    AutoTypeNode() : TypeNode(TypeCategory::PRIMITIVE) {} // Treat as primitive for simplicity, actual type deduced later
+    std::string typeName() const override {
+        return "auto (deducing)";
+    }
+};
+
+// Owns every type the compiler ever builds and hands out the canonical instance,
+// e.g. pointerTo(t) returns the same node for the same t every time.
+// Types live until the process exits, like interned identifiers.
+// Safe to call from several threads (the parallel parser does): primitives are all
+// built up front and read without locking, the other kinds are looked up under a mutex.
+class TypeContext {
+public:
+    static TypeContext& global();
+
+    const PrimitiveTypeNode* primitive(Token::Type type) const { return primitives[type]; }
+    const PointerTypeNode* pointerTo(const TypeNode* base);
+    const ArrayTypeNode* arrayOf(const TypeNode* base, int size);
+    const StructTypeNode* structNamed(const std::string& name);
+    const AutoTypeNode* autoType() { return auto_type; }
+
+private:
+    TypeContext();
+
+    template <typename T, typename... Args>
+    const T* make(Args&&... args) {
+        auto type = std::make_unique<T>(std::forward<Args>(args)...);
+        type->id = static_cast<uint32_t>(storage.size());
+        const T* result = type.get();
+        storage.push_back(std::move(type));
+        return result;
+    }
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TypeNode>> storage;
+    std::array<const PrimitiveTypeNode*, Token::UNKNOWN + 1> primitives;
+    std::unordered_map<const TypeNode*, const PointerTypeNode*> pointers;
+    std::map<std::pair<const TypeNode*, int>, const ArrayTypeNode*> arrays;
+    std::unordered_map<std::string, const StructTypeNode*> structs;
+    const AutoTypeNode* auto_type;
+};
+
+inline const PrimitiveTypeNode* primitiveType(Token::Type type) { return TypeContext::global().primitive(type); }
+inline const PointerTypeNode* pointerType(const TypeNode* base) { return TypeContext::global().pointerTo(base); }
+inline const ArrayTypeNode* arrayType(const TypeNode* base, int size) { return TypeContext::global().arrayOf(base, size); }
+inline const StructTypeNode* structType(const std::string& name) { return TypeContext::global().structNamed(name); }
+inline const AutoTypeNode* autoType() { return TypeContext::global().autoType(); }
+
+#endif // TYPES_HPP
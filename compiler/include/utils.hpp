@@ -6,6 +6,7 @@
 #include <cctype>
 #include <fstream>
 #include <vector>
+#include "interner.hpp"
 
 namespace Utils {
     static std::string cleanString(std::string s) {
@@ -34,23 +35,28 @@ namespace Utils {
 };
 
 namespace Mangler {
-    inline std::string mangleVariable(const std::vector<std::string>& scopes, const std::string& varName) {
+    inline std::string mangleVariable(const std::vector<Ident>& scopes, Ident varName) {
         std::string result = "_N";
-        for (const auto& scope : scopes) {
-            result += std::to_string(scope.length()) + scope;
+        for (Ident scope : scopes) {
+            const std::string& text = spelling(scope);
+            result += std::to_string(text.length()) + text;
         }
-        result += std::to_string(varName.length()) + varName;
+        const std::string& name = spelling(varName);
+        result += std::to_string(name.length()) + name;
         return result;
     }
 
-    inline std::string mangleFunction(const std::vector<std::string>& scopes, const std::string& name) {
-        if (name == "main") return "main";
+    inline std::string mangleFunction(const std::vector<Ident>& scopes, Ident name) {
+        static const Ident main_ident = intern("main");
+        if (name == main_ident) return "main";
 
         std::string result = "_N";
-        for (const auto& scope : scopes) {
-            result += std::to_string(scope.length()) + scope;
+        for (Ident scope : scopes) {
+            const std::string& text = spelling(scope);
+            result += std::to_string(text.length()) + text;
         }
-        result += std::to_string(name.length()) + name;
+        const std::string& text = spelling(name);
+        result += std::to_string(text.length()) + text;
         return result;
     }
 }
@@ -0,0 +1,759 @@
+#include "ast_cache.hpp"
+#include "source_buffer.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#ifndef NYTRO_VERSION
+#define NYTRO_VERSION "dev" // Set by the top-level build
+#endif
+
+// File layout, all integers in host byte order:
+//   magic "NYTAST\0\0", u32 format, u64 schema hash, str compiler version, u64 source hash
+//   u32 count, str * count          identifier spellings, index 0 is always ""
+//   u32 count, type * count         each type only refers to types before it
+//   program node
+// A str is a u32 length and the bytes. A node is a u8 NodeType (0xFF for a missing
+// child), its u32 SourceLoc and its own fields (list lengths included), then each of
+// its children in turn. Nothing of a node follows its children, so the writer and the
+// reader can keep the pending children on a stack instead of recursing per level.
+
+namespace {
+
+constexpr char MAGIC[8] = {'N', 'Y', 'T', 'A', 'S', 'T', 0, 0};
+constexpr uint8_t NO_NODE = 0xFF;
+constexpr uint32_t NO_TYPE = 0xFFFFFFFF;
+
+// Token and node kinds are written as their enum values, so a file is only good for the
+// TOKEN_LIST and AST_NODE_LIST it was written with. Their spellings, in order, are hashed
+// into the header: adding or moving an entry is a miss even if nobody bumps the format.
+constexpr uint64_t fnv1a(uint64_t hash, std::string_view text) {
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+constexpr uint64_t SCHEMA_HASH = [] {
+    uint64_t hash = 0xcbf29ce484222325ull;
+#define HASH_TOKEN(name, str) hash = fnv1a(fnv1a(hash, #name), str);
+    TOKEN_LIST(HASH_TOKEN)
+#undef HASH_TOKEN
+#define HASH_NODE(type, cls, name) hash = fnv1a(fnv1a(fnv1a(hash, #type), #cls), name);
+    AST_NODE_LIST(HASH_NODE)
+#undef HASH_NODE
+    return hash;
+}();
+
+enum TypeTag : uint8_t { TYPE_PRIMITIVE, TYPE_POINTER, TYPE_ARRAY, TYPE_STRUCT, TYPE_AUTO };
+
+using NodeType = ASTNode::NodeType;
+
+class CacheWriter {
+public:
+    std::string finish(const ProgramNode& program, uint64_t source_hash) {
+        write(program);
+
+        std::string out(MAGIC, sizeof(MAGIC));
+        put<uint32_t>(out, AST_CACHE_FORMAT);
+        put<uint64_t>(out, SCHEMA_HASH);
+        putString(out, NYTRO_VERSION);
+        put<uint64_t>(out, source_hash);
+        put<uint32_t>(out, static_cast<uint32_t>(idents.size()));
+        for (Ident id : idents) putString(out, spelling(id));
+        put<uint32_t>(out, type_count);
+        out += types;
+        out += nodes;
+        return out;
+    }
+
+private:
+    std::string nodes;
+    std::string types;
+    uint32_t type_count = 0;
+    std::vector<Ident> idents{NO_IDENT};
+    std::unordered_map<Ident, uint32_t> ident_index{{NO_IDENT, 0}};
+    std::unordered_map<const TypeNode*, uint32_t> type_index;
+    std::vector<const ASTNode*> pending;  // Nodes still to write, next on top
+    std::vector<const ASTNode*> children; // The current node's, in the order they're written
+
+    template <typename T>
+    static void put(std::string& buf, T value) { buf.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+    static void putString(std::string& buf, std::string_view s) {
+        put<uint32_t>(buf, static_cast<uint32_t>(s.size()));
+        buf.append(s);
+    }
+
+    template <typename T>
+    void put(T value) { put<T>(nodes, value); }
+    void putString(std::string_view s) { putString(nodes, s); }
+
+    void ident(Ident id) {
+        auto it = ident_index.find(id);
+        if (it == ident_index.end()) {
+            it = ident_index.emplace(id, static_cast<uint32_t>(idents.size())).first;
+            idents.push_back(id);
+        }
+        put<uint32_t>(it->second);
+    }
+
+    uint32_t typeIndex(const TypeNode* type) {
+        if (!type) return NO_TYPE;
+        auto it = type_index.find(type);
+        if (it != type_index.end()) return it->second;
+
+        // Bases first, so the loader can build every type from ones it already has
+        std::string entry;
+        if (type == autoType()) {
+            put<uint8_t>(entry, TYPE_AUTO);
+        } else if (auto* prim = dynamic_cast<const PrimitiveTypeNode*>(type)) {
+            put<uint8_t>(entry, TYPE_PRIMITIVE);
+            put<uint16_t>(entry, static_cast<uint16_t>(prim->primitive_type));
+        } else if (auto* ptr = dynamic_cast<const PointerTypeNode*>(type)) {
+            uint32_t base = typeIndex(ptr->base_type);
+            put<uint8_t>(entry, TYPE_POINTER);
+            put<uint32_t>(entry, base);
+        } else if (auto* arr = dynamic_cast<const ArrayTypeNode*>(type)) {
+            uint32_t base = typeIndex(arr->base_type);
+            put<uint8_t>(entry, TYPE_ARRAY);
+            put<uint32_t>(entry, base);
+            put<int32_t>(entry, arr->size);
+        } else if (auto* st = dynamic_cast<const StructTypeNode*>(type)) {
+            put<uint8_t>(entry, TYPE_STRUCT);
+            putString(entry, st->struct_name);
+        } else {
+            throw std::runtime_error("AST cache: unknown type " + type->typeName());
+        }
+        types += entry;
+        return type_index[type] = type_count++;
+    }
+
+    void type(const TypeNode* t) { put<uint32_t>(typeIndex(t)); }
+
+    void child(const ASTNode* n) { children.push_back(n); }
+
+    template <typename T>
+    void list(const std::vector<NodePtr<T>>& nodes) {
+        put<uint32_t>(static_cast<uint32_t>(nodes.size()));
+        for (auto& n : nodes) child(n.get());
+    }
+
+    void write(const ProgramNode& program) {
+        pending.push_back(&program);
+        while (!pending.empty()) {
+            const ASTNode* n = pending.back();
+            pending.pop_back();
+            if (!n) {
+                put<uint8_t>(NO_NODE);
+                continue;
+            }
+            put<uint8_t>(static_cast<uint8_t>(n->node_type));
+            nodeFields(*n);
+            pending.insert(pending.end(), children.rbegin(), children.rend()); // First child on top
+            children.clear();
+        }
+    }
+
+    void nodeFields(const ASTNode& n) {
+        put<uint32_t>(n.loc);
+
+        switch (n.node_type) {
+            case NodeType::PROGRAM: {
+                auto& p = static_cast<const ProgramNode&>(n);
+                list(p.statements);
+                list(p.functions);
+                list(p.structs);
+                break;
+            }
+            case NodeType::INTEGER_LITERAL_EXPRESSION:
+                put<int32_t>(static_cast<const IntegerLiteralExpressionNode&>(n).value);
+                break;
+            case NodeType::STRING_LITERAL_EXPRESSION:
+                putString(static_cast<const StringLiteralExpressionNode&>(n).value);
+                break;
+            case NodeType::BOOLEAN_LITERAL_EXPRESSION:
+                put<uint8_t>(static_cast<const BooleanLiteralExpressionNode&>(n).value);
+                break;
+            case NodeType::CHARACTER_LITERAL_EXPRESSION:
+                put<char>(static_cast<const CharacterLiteralExpressionNode&>(n).value);
+                break;
+            case NodeType::FLOAT_LITERAL_EXPRESSION:
+                put<float>(static_cast<const FloatLiteralExpressionNode&>(n).value);
+                break;
+            case NodeType::DOUBLE_LITERAL_EXPRESSION:
+                put<double>(static_cast<const DoubleLiteralExpressionNode&>(n).value);
+                break;
+            case NodeType::RETURN_STATEMENT:
+                child(static_cast<const ReturnStatementNode&>(n).expression.get());
+                break;
+            case NodeType::STRUCT_DEFINITION: {
+                auto& s = static_cast<const StructDefinitionNode&>(n);
+                putString(s.name);
+                put<uint8_t>(s.packed);
+                put<uint8_t>(s.reorder);
+                put<int32_t>(s.explicit_align);
+                put<uint32_t>(static_cast<uint32_t>(s.members.size()));
+                for (auto& m : s.members) {
+                    type(m.type);
+                    ident(m.name);
+                    put<uint8_t>(static_cast<uint8_t>(m.visibility));
+                }
+                break;
+            }
+            case NodeType::MEMBER_ACCESS_EXPRESSION: {
+                auto& m = static_cast<const MemberAccessNode&>(n);
+                ident(m.member_name);
+                child(m.struct_expr.get());
+                break;
+            }
+            case NodeType::NAMESPACE_DEFINITION: {
+                auto& ns = static_cast<const NamespaceDefinition&>(n);
+                ident(ns.name);
+                put<uint32_t>(static_cast<uint32_t>(ns.members.size()));
+                for (auto& m : ns.members) {
+                    ident(m.name);
+                    child(m.node.get());
+                }
+                break;
+            }
+            case NodeType::SCOPE_RESOLUTION: {
+                auto& s = static_cast<const ScopeResolutionNode&>(n);
+                ident(s.namespace_name);
+                child(s.member.get());
+                break;
+            }
+            case NodeType::VARIABLE_DECLARATION: {
+                auto& v = static_cast<const VariableDeclarationNode&>(n);
+                type(v.type);
+                put<int32_t>(v.align);
+                put<uint32_t>(static_cast<uint32_t>(v.declarations.size()));
+                for (auto& d : v.declarations) {
+                    ident(d.name);
+                    child(d.initial_value.get());
+                }
+                break;
+            }
+            case NodeType::VARIABLE_ASSIGNMENT: {
+                auto& a = static_cast<const VariableAssignmentNode&>(n);
+                child(a.left.get());
+                child(a.right.get());
+                break;
+            }
+            case NodeType::VARIABLE_REFERENCE: {
+                auto& v = static_cast<const VariableReferenceNode&>(n);
+                ident(v.name);
+                put<uint32_t>(static_cast<uint32_t>(v.scopes.size()));
+                for (auto& scope : v.scopes) putString(scope);
+                break;
+            }
+            case NodeType::UNARY_OP_EXPRESSION: {
+                auto& u = static_cast<const UnaryOpExpressionNode&>(n);
+                put<uint16_t>(static_cast<uint16_t>(u.op_type));
+                child(u.operand.get());
+                break;
+            }
+            case NodeType::ARRAY_ACCESS_EXPRESSION: {
+                auto& a = static_cast<const ArrayAccessNode&>(n);
+                child(a.array_expr.get());
+                child(a.index_expr.get());
+                break;
+            }
+            case NodeType::FUNCTION_DEFINITION: {
+                auto& f = static_cast<const FunctionDefinitionNode&>(n);
+                type(f.return_type);
+                ident(f.name);
+                put<uint8_t>(f.is_extern);
+                put<uint32_t>(static_cast<uint32_t>(f.parameters.size()));
+                for (auto& p : f.parameters) {
+                    type(p->type);
+                    ident(p->name);
+                    put<int32_t>(p->offset);
+                }
+                list(f.body_statements);
+                break;
+            }
+            case NodeType::FUNCTION_CALL: {
+                auto& c = static_cast<const FunctionCallNode&>(n);
+                ident(c.function_name);
+                list(c.arguments);
+                break;
+            }
+            case NodeType::WHILE_STATEMENT: {
+                auto& w = static_cast<const WhileStatementNode&>(n);
+                child(w.condition.get());
+                list(w.body);
+                break;
+            }
+            case NodeType::FOR_STATEMENT: {
+                auto& f = static_cast<const ForStatementNode&>(n);
+                child(f.initializer.get());
+                child(f.condition.get());
+                child(f.increment.get());
+                list(f.body);
+                break;
+            }
+            case NodeType::BINARY_OPERATION_EXPRESSION: {
+                auto& b = static_cast<const BinaryOperationExpressionNode&>(n);
+                put<uint16_t>(static_cast<uint16_t>(b.op_type));
+                child(b.left.get());
+                child(b.right.get());
+                break;
+            }
+            case NodeType::PRINT_STATEMENT:
+                list(static_cast<const PrintStatementNode&>(n).expressions);
+                break;
+            case NodeType::IF_STATEMENT: {
+                auto& i = static_cast<const IfStatementNode&>(n);
+                child(i.condition.get());
+                list(i.true_block);
+                list(i.false_block);
+                break;
+            }
+            case NodeType::SWITCH_STATEMENT: {
+                auto& s = static_cast<const SwitchStatementNode&>(n);
+                child(s.condition.get());
+                put<uint32_t>(static_cast<uint32_t>(s.cases.size()));
+                for (auto& c : s.cases) {
+                    put<uint8_t>(c.is_default);
+                    child(c.constant_expr.get());
+                    list(c.body);
+                }
+                break;
+            }
+            case NodeType::ASM_STATEMENT: {
+                auto& a = static_cast<const AsmStatementNode&>(n);
+                put<uint32_t>(static_cast<uint32_t>(a.lines.size()));
+                for (auto& line : a.lines) putString(line);
+                break;
+            }
+            case NodeType::CONSTANT_DECLARATION: {
+                auto& c = static_cast<const ConstantDeclarationNode&>(n);
+                ident(c.name);
+                type(c.type);
+                child(c.initial_value.get());
+                break;
+            }
+            case NodeType::ENUM_STATEMENT: {
+                auto& e = static_cast<const EnumStatementNode&>(n);
+                ident(e.name);
+                put<uint32_t>(static_cast<uint32_t>(e.members.size()));
+                for (auto& m : e.members) {
+                    ident(m->name);
+                    child(m->value.get());
+                }
+                break;
+            }
+            default:
+                throw std::runtime_error("AST cache: cannot write node " + n.type_name());
+        }
+    }
+};
+
+class CacheReader {
+public:
+    CacheReader(std::string_view data, ProgramNode& program) : data(data), program(program) {}
+
+    // False if the header doesn't match, throws if the file is damaged
+    bool header(uint64_t source_hash) {
+        if (data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) return false;
+        pos = sizeof(MAGIC);
+        if (get<uint32_t>() != AST_CACHE_FORMAT) return false;
+        if (get<uint64_t>() != SCHEMA_HASH) return false;
+        if (getString() != NYTRO_VERSION) return false;
+        if (get<uint64_t>() != source_hash) return false;
+
+        idents.resize(get<uint32_t>());
+        for (auto& id : idents) id = intern(getString());
+        types.resize(get<uint32_t>());
+        for (size_t i = 0; i < types.size(); ++i) types[i] = readType(i);
+        return true;
+    }
+
+    void body() {
+        if (get<uint8_t>() != static_cast<uint8_t>(NodeType::PROGRAM)) fail();
+        programFields();
+        if (pos != data.size()) fail();
+    }
+
+private:
+    std::string_view data;
+    size_t pos = 0;
+    ProgramNode& program;
+    std::vector<Ident> idents;
+    std::vector<const TypeNode*> types;
+
+    [[noreturn]] static void fail() { throw std::runtime_error("AST cache: damaged file"); }
+
+    template <typename T>
+    T get() {
+        if (data.size() - pos < sizeof(T)) fail();
+        T value;
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    std::string_view getString() {
+        uint32_t length = get<uint32_t>();
+        if (data.size() - pos < length) fail();
+        std::string_view s = data.substr(pos, length);
+        pos += length;
+        return s;
+    }
+
+    Ident ident() {
+        uint32_t index = get<uint32_t>();
+        if (index >= idents.size()) fail();
+        return idents[index];
+    }
+
+    const TypeNode* type() {
+        uint32_t index = get<uint32_t>();
+        if (index == NO_TYPE) return nullptr;
+        if (index >= types.size()) fail();
+        return types[index];
+    }
+
+    const TypeNode* readType(size_t index) {
+        auto base = [&] {
+            uint32_t base_index = get<uint32_t>();
+            if (base_index >= index) fail();
+            return types[base_index];
+        };
+        switch (get<uint8_t>()) {
+            case TYPE_PRIMITIVE: {
+                uint16_t kind = get<uint16_t>();
+                if (kind > Token::UNKNOWN) fail();
+                return primitiveType(static_cast<Token::Type>(kind));
+            }
+            case TYPE_POINTER: return pointerType(base());
+            case TYPE_ARRAY: {
+                const TypeNode* element = base();
+                return arrayType(element, get<int32_t>());
+            }
+            case TYPE_STRUCT: return structType(std::string(getString()));
+            case TYPE_AUTO: return autoType();
+            default: fail();
+        }
+    }
+
+    Token::Type tokenType() {
+        uint16_t kind = get<uint16_t>();
+        if (kind > Token::UNKNOWN) fail();
+        return static_cast<Token::Type>(kind);
+    }
+
+    template <typename T, typename... Args>
+    NodePtr<T> make(Args&&... args) { return program.arena.make<T>(std::forward<Args>(args)...); }
+
+    // A node is made with its children empty, child() records where each one goes.
+    // They are read into those slots once the node's own fields are done.
+    std::vector<NodePtr<ASTNode>*> pending;  // Slots still to read, next on top
+    std::vector<NodePtr<ASTNode>*> children; // The current node's, in the order they're written
+
+    void child(NodePtr<ASTNode>& slot) { children.push_back(&slot); }
+
+    void list(std::vector<NodePtr<ASTNode>>& nodes) {
+        nodes.resize(get<uint32_t>());
+        for (auto& n : nodes) child(n);
+    }
+
+    void readChildren() {
+        pending.insert(pending.end(), children.rbegin(), children.rend()); // First child on top
+        children.clear();
+        while (!pending.empty()) {
+            NodePtr<ASTNode>* slot = pending.back();
+            pending.pop_back();
+            uint8_t kind = get<uint8_t>();
+            if (kind == NO_NODE) continue;
+            if (kind == static_cast<uint8_t>(NodeType::PROGRAM)) fail();
+            *slot = nodeFields(static_cast<NodeType>(kind));
+            pending.insert(pending.end(), children.rbegin(), children.rend());
+            children.clear();
+        }
+    }
+
+    // For the typed lists in ProgramNode
+    template <typename T>
+    static void typed(std::vector<NodePtr<ASTNode>>& nodes, std::vector<NodePtr<T>>& out, NodeType expected) {
+        out.reserve(nodes.size());
+        for (auto& n : nodes) {
+            if (!n || n->node_type != expected) fail();
+            NodeDeleter deleter = n.get_deleter();
+            out.emplace_back(static_cast<T*>(n.release()), deleter);
+        }
+    }
+
+    void programFields() {
+        program.loc = get<uint32_t>();
+        std::vector<NodePtr<ASTNode>> functions, structs;
+        list(program.statements);
+        list(functions);
+        list(structs);
+        readChildren();
+        typed(functions, program.functions, NodeType::FUNCTION_DEFINITION);
+        typed(structs, program.structs, NodeType::STRUCT_DEFINITION);
+    }
+
+    NodePtr<ASTNode> nodeFields(NodeType kind) {
+        SourceLoc loc = get<uint32_t>();
+        NodePtr<ASTNode> result;
+
+        switch (kind) {
+            case NodeType::INTEGER_LITERAL_EXPRESSION:
+                result = make<IntegerLiteralExpressionNode>(get<int32_t>());
+                break;
+            case NodeType::STRING_LITERAL_EXPRESSION:
+                result = make<StringLiteralExpressionNode>(std::string(getString()));
+                break;
+            case NodeType::BOOLEAN_LITERAL_EXPRESSION:
+                result = make<BooleanLiteralExpressionNode>(get<uint8_t>());
+                break;
+            case NodeType::CHARACTER_LITERAL_EXPRESSION:
+                result = make<CharacterLiteralExpressionNode>(get<char>());
+                break;
+            case NodeType::FLOAT_LITERAL_EXPRESSION:
+                result = make<FloatLiteralExpressionNode>(get<float>());
+                break;
+            case NodeType::DOUBLE_LITERAL_EXPRESSION:
+                result = make<DoubleLiteralExpressionNode>(get<double>());
+                break;
+            case NodeType::RETURN_STATEMENT: {
+                auto r = make<ReturnStatementNode>(nullptr);
+                child(r->expression);
+                result = std::move(r);
+                break;
+            }
+            case NodeType::STRUCT_DEFINITION: {
+                auto s = make<StructDefinitionNode>(std::string(getString()));
+                s->packed = get<uint8_t>() != 0;
+                s->reorder = get<uint8_t>() != 0;
+                s->explicit_align = get<int32_t>();
+                s->members.resize(get<uint32_t>());
+                for (auto& m : s->members) {
+                    m.type = type();
+                    m.name = ident();
+                    m.offset = 0;
+                    m.visibility = static_cast<StructMember::Visibility>(get<uint8_t>());
+                }
+                result = std::move(s);
+                break;
+            }
+            case NodeType::MEMBER_ACCESS_EXPRESSION: {
+                auto m = make<MemberAccessNode>(nullptr, ident());
+                child(m->struct_expr);
+                result = std::move(m);
+                break;
+            }
+            case NodeType::NAMESPACE_DEFINITION: {
+                auto ns = make<NamespaceDefinition>(ident());
+                ns->members.resize(get<uint32_t>());
+                for (auto& m : ns->members) {
+                    m.name = ident();
+                    child(m.node);
+                }
+                result = std::move(ns);
+                break;
+            }
+            case NodeType::SCOPE_RESOLUTION: {
+                auto s = make<ScopeResolutionNode>(ident(), nullptr);
+                child(s->member);
+                result = std::move(s);
+                break;
+            }
+            case NodeType::VARIABLE_DECLARATION: {
+                auto v = make<VariableDeclarationNode>(type(), std::vector<Declaration>());
+                v->align = get<int32_t>();
+                v->declarations.resize(get<uint32_t>());
+                for (auto& d : v->declarations) {
+                    d.name = ident();
+                    child(d.initial_value);
+                }
+                result = std::move(v);
+                break;
+            }
+            case NodeType::VARIABLE_ASSIGNMENT: {
+                auto a = make<VariableAssignmentNode>(nullptr, nullptr);
+                child(a->left);
+                child(a->right);
+                result = std::move(a);
+                break;
+            }
+            case NodeType::VARIABLE_REFERENCE: {
+                auto v = make<VariableReferenceNode>(ident());
+                v->scopes.resize(get<uint32_t>());
+                for (auto& scope : v->scopes) scope = getString();
+                result = std::move(v);
+                break;
+            }
+            case NodeType::UNARY_OP_EXPRESSION: {
+                auto u = make<UnaryOpExpressionNode>(tokenType(), nullptr);
+                child(u->operand);
+                result = std::move(u);
+                break;
+            }
+            case NodeType::ARRAY_ACCESS_EXPRESSION: {
+                auto a = make<ArrayAccessNode>(nullptr, nullptr);
+                child(a->array_expr);
+                child(a->index_expr);
+                result = std::move(a);
+                break;
+            }
+            case NodeType::FUNCTION_DEFINITION: {
+                const TypeNode* return_type = type();
+                auto f = make<FunctionDefinitionNode>(return_type, ident());
+                f->is_extern = get<uint8_t>();
+                f->parameters.resize(get<uint32_t>());
+                for (auto& p : f->parameters) {
+                    p = std::make_unique<ParameterNode>();
+                    p->type = type();
+                    p->name = ident();
+                    p->offset = get<int32_t>();
+                }
+                list(f->body_statements);
+                result = std::move(f);
+                break;
+            }
+            case NodeType::FUNCTION_CALL: {
+                auto c = make<FunctionCallNode>(ident(), std::vector<NodePtr<ASTNode>>());
+                list(c->arguments);
+                result = std::move(c);
+                break;
+            }
+            case NodeType::WHILE_STATEMENT: {
+                auto w = make<WhileStatementNode>(nullptr, std::vector<NodePtr<ASTNode>>());
+                child(w->condition);
+                list(w->body);
+                result = std::move(w);
+                break;
+            }
+            case NodeType::FOR_STATEMENT: {
+                auto f = make<ForStatementNode>(nullptr, nullptr, nullptr, std::vector<NodePtr<ASTNode>>());
+                child(f->initializer);
+                child(f->condition);
+                child(f->increment);
+                list(f->body);
+                result = std::move(f);
+                break;
+            }
+            case NodeType::BINARY_OPERATION_EXPRESSION: {
+                auto b = make<BinaryOperationExpressionNode>(nullptr, tokenType(), nullptr);
+                child(b->left);
+                child(b->right);
+                result = std::move(b);
+                break;
+            }
+            case NodeType::PRINT_STATEMENT: {
+                auto p = make<PrintStatementNode>(std::vector<NodePtr<ASTNode>>());
+                list(p->expressions);
+                result = std::move(p);
+                break;
+            }
+            case NodeType::IF_STATEMENT: {
+                auto i = make<IfStatementNode>(nullptr, std::vector<NodePtr<ASTNode>>(), std::vector<NodePtr<ASTNode>>());
+                child(i->condition);
+                list(i->true_block);
+                list(i->false_block);
+                result = std::move(i);
+                break;
+            }
+            case NodeType::SWITCH_STATEMENT: {
+                auto s = make<SwitchStatementNode>();
+                child(s->condition);
+                s->cases.resize(get<uint32_t>());
+                for (auto& c : s->cases) {
+                    c.is_default = get<uint8_t>();
+                    child(c.constant_expr);
+                    list(c.body);
+                }
+                result = std::move(s);
+                break;
+            }
+            case NodeType::ASM_STATEMENT: {
+                std::vector<std::string> lines(get<uint32_t>());
+                for (auto& asm_line : lines) asm_line = getString();
+                result = make<AsmStatementNode>(std::move(lines));
+                break;
+            }
+            case NodeType::CONSTANT_DECLARATION: {
+                Ident name = ident();
+                auto c = make<ConstantDeclarationNode>(name, type(), nullptr);
+                child(c->initial_value);
+                result = std::move(c);
+                break;
+            }
+            case NodeType::ENUM_STATEMENT: {
+                auto e = make<EnumStatementNode>(ident(), std::vector<std::unique_ptr<EnumMemberNode>>());
+                e->members.resize(get<uint32_t>());
+                for (auto& m : e->members) {
+                    m = std::make_unique<EnumMemberNode>(ident());
+                    child(m->value);
+                }
+                result = std::move(e);
+                break;
+            }
+            default:
+                fail();
+        }
+
+        result->loc = loc;
+        return result;
+    }
+};
+
+} // namespace
+
+uint64_t hashSource(std::string_view text) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool writeASTCache(const std::string& path, const ProgramNode& program, uint64_t source_hash) {
+    std::string bytes;
+    try {
+        bytes = CacheWriter().finish(program, source_hash);
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    // Written next to the target and renamed over it, so a reader never sees half a file.
+    // The temporary is named after the process: two compilers writing the same cache
+    // would otherwise share it, and one could rename the other's half-written file.
+    std::string temp_path = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write(bytes.data(), bytes.size())) {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<ProgramNode> loadASTCache(const std::string& path, uint64_t source_hash) {
+    SourceBuffer file;
+    if (!file.open(path) || file.empty()) return nullptr;
+
+    auto program = std::make_unique<ProgramNode>();
+    try {
+        CacheReader reader(file.text(), *program);
+        if (!reader.header(source_hash)) return nullptr;
+        reader.body();
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+    return program;
+}
@@ -0,0 +1,241 @@
+#include "ast_export.hpp"
+#include "symbol_table.hpp"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using NodeType = ASTNode::NodeType;
+
+const char* symbolKindName(Symbol::SymbolType kind) {
+    switch (kind) {
+        case Symbol::SymbolType::VARIABLE:             return "VARIABLE";
+        case Symbol::SymbolType::FUNCTION:             return "FUNCTION";
+        case Symbol::SymbolType::STRUCT_DEFINITION:    return "STRUCT_DEFINITION";
+        case Symbol::SymbolType::STRUCT_MEMBER:        return "STRUCT_MEMBER";
+        case Symbol::SymbolType::CONSTANT:             return "CONSTANT";
+        case Symbol::SymbolType::ENUM_TYPE:            return "ENUM_TYPE";
+        case Symbol::SymbolType::ENUM_MEMBER:          return "ENUM_MEMBER";
+        case Symbol::SymbolType::NAMESPACE_DEFINITION: return "NAMESPACE_DEFINITION";
+    }
+    return "UNKNOWN";
+}
+
+const char* operatorSpelling(Token::Type op) {
+    static const char* spellings[] = {
+#define AS_SPELLING(name, str) str,
+        TOKEN_LIST(AS_SPELLING)
+#undef AS_SPELLING
+    };
+    return op >= 0 && op < static_cast<int>(sizeof(spellings) / sizeof(spellings[0])) ? spellings[op] : "?";
+}
+
+// The name a node introduces or refers to, or its literal value
+std::string nodeLabel(const ASTNode& node) {
+    switch (node.node_type) {
+        case NodeType::FUNCTION_DEFINITION:      return spelling(static_cast<const FunctionDefinitionNode&>(node).name);
+        case NodeType::FUNCTION_CALL:            return spelling(static_cast<const FunctionCallNode&>(node).function_name);
+        case NodeType::STRUCT_DEFINITION:        return static_cast<const StructDefinitionNode&>(node).name;
+        case NodeType::MEMBER_ACCESS_EXPRESSION: return spelling(static_cast<const MemberAccessNode&>(node).member_name);
+        case NodeType::NAMESPACE_DEFINITION:     return spelling(static_cast<const NamespaceDefinition&>(node).name);
+        case NodeType::SCOPE_RESOLUTION:         return spelling(static_cast<const ScopeResolutionNode&>(node).namespace_name);
+        case NodeType::CONSTANT_DECLARATION:     return spelling(static_cast<const ConstantDeclarationNode&>(node).name);
+        case NodeType::ENUM_STATEMENT:           return spelling(static_cast<const EnumStatementNode&>(node).name);
+        case NodeType::UNARY_OP_EXPRESSION:      return operatorSpelling(static_cast<const UnaryOpExpressionNode&>(node).op_type);
+        case NodeType::BINARY_OPERATION_EXPRESSION:
+            return operatorSpelling(static_cast<const BinaryOperationExpressionNode&>(node).op_type);
+        case NodeType::VARIABLE_DECLARATION: {
+            std::string names;
+            for (auto& decl : static_cast<const VariableDeclarationNode&>(node).declarations) {
+                if (!names.empty()) names += ",";
+                names += spelling(decl.name);
+            }
+            return names;
+        }
+        default:
+            return node.get_value();
+    }
+}
+
+const Symbol* resolvedSymbol(const ASTNode& node) {
+    switch (node.node_type) {
+        case NodeType::VARIABLE_REFERENCE:       return static_cast<const VariableReferenceNode&>(node).resolved_symbol;
+        case NodeType::FUNCTION_CALL:            return static_cast<const FunctionCallNode&>(node).resolved_symbol;
+        case NodeType::MEMBER_ACCESS_EXPRESSION: return static_cast<const MemberAccessNode&>(node).resolved_symbol;
+        case NodeType::SCOPE_RESOLUTION:         return static_cast<const ScopeResolutionNode&>(node).resolved_symbol;
+        case NodeType::UNARY_OP_EXPRESSION:      return static_cast<const UnaryOpExpressionNode&>(node).resolved_symbol;
+        case NodeType::ARRAY_ACCESS_EXPRESSION:  return static_cast<const ArrayAccessNode&>(node).resolved_symbol;
+        case NodeType::CONSTANT_DECLARATION:     return static_cast<const ConstantDeclarationNode&>(node).resolved_symbol;
+        default:                                 return nullptr;
+    }
+}
+
+// Flattens the tree into pre-order records with a deduplicated string table,
+// both output formats are written from these
+class RecordBuilder {
+public:
+    std::vector<ASTExportRecord> records;
+    std::vector<std::string> strings{""};
+    std::vector<ASTExportFunction> functions;
+
+    explicit RecordBuilder(const ASTExportOptions& options) : options(options) {}
+
+    void add(const ASTNode& node, uint32_t parent) {
+        uint32_t id = static_cast<uint32_t>(records.size());
+        const Symbol* symbol = resolvedSymbol(node);
+
+        ASTExportRecord record{};
+        record.kind = static_cast<uint16_t>(node.node_type);
+        record.symbol_kind = symbol ? static_cast<uint8_t>(static_cast<int>(symbol->type) + 1) : 0;
+        PresumedLoc where = SourceManager::global().presumed(node.loc);
+        record.line = where.line;
+        record.column = where.column;
+        record.file = string(std::string(where.file));
+        record.parent = id == 0 ? 0 : parent;
+        record.label = string(nodeLabel(node));
+        record.type = node.resolved_type ? string(node.resolved_type->typeName()) : 0;
+        record.symbol = symbol ? string(spelling(symbol->name)) : 0;
+        records.push_back(record);
+        if (node.node_type == NodeType::FUNCTION_DEFINITION) functions.push_back({record.label, id});
+
+        node.for_each_child([&](ASTNode* child) {
+            if (wanted(node, *child)) add(*child, id);
+        });
+        records[id].subtree_end = static_cast<uint32_t>(records.size());
+    }
+
+private:
+    const ASTExportOptions& options;
+    std::unordered_map<std::string, uint32_t> string_index;
+
+    uint32_t string(const std::string& s) {
+        if (s.empty()) return 0;
+        auto it = string_index.find(s);
+        if (it != string_index.end()) return it->second;
+        strings.push_back(s);
+        return string_index[s] = static_cast<uint32_t>(strings.size() - 1);
+    }
+
+    // With a function filter only the chosen functions are kept, plus the program and
+    // namespaces on the way down to them
+    bool wanted(const ASTNode& parent, const ASTNode& child) const {
+        if (options.functions.empty()) return true;
+        if (parent.node_type != NodeType::PROGRAM && parent.node_type != NodeType::NAMESPACE_DEFINITION) return true;
+        if (child.node_type == NodeType::NAMESPACE_DEFINITION) return true;
+        return child.node_type == NodeType::FUNCTION_DEFINITION &&
+               options.functions.count(spelling(static_cast<const FunctionDefinitionNode&>(child).name));
+    }
+};
+
+void writeJSONString(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            case '\r': out << "\\r"; break;
+            default:
+                if (c < 0x20) {
+                    static const char hex[] = "0123456789abcdef";
+                    out << "\\u00" << hex[c >> 4] << hex[c & 15];
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+void writeJSONStringOrNull(std::ostream& out, const RecordBuilder& builder, uint32_t index) {
+    if (index == 0) out << "null";
+    else writeJSONString(out, builder.strings[index]);
+}
+
+// Nested objects, written straight from the flat records with a stack of open subtrees
+void writeJSON(std::ostream& out, const RecordBuilder& builder) {
+    out << "{\"format\":" << AST_EXPORT_FORMAT << ",\"root\":\n";
+    std::vector<uint32_t> open; // subtree_end of every node whose children are being written
+    bool first = true;
+    for (uint32_t id = 0; id < builder.records.size(); ++id) {
+        const ASTExportRecord& r = builder.records[id];
+        if (!first) out << ",\n";
+        out << std::string(open.size() * 2, ' ');
+        out << "{\"id\":" << id << ",\"kind\":\"" << nodeTypeName(static_cast<NodeType>(r.kind))
+            << "\",\"file\":";
+        writeJSONStringOrNull(out, builder, r.file);
+        out << ",\"line\":" << r.line << ",\"column\":" << r.column << ",\"label\":";
+        writeJSONStringOrNull(out, builder, r.label);
+        out << ",\"type\":";
+        writeJSONStringOrNull(out, builder, r.type);
+        out << ",\"symbol\":";
+        if (r.symbol_kind == 0) {
+            out << "null";
+        } else {
+            out << "{\"name\":";
+            writeJSONString(out, builder.strings[r.symbol]);
+            out << ",\"kind\":\"" << symbolKindName(static_cast<Symbol::SymbolType>(r.symbol_kind - 1)) << "\"}";
+        }
+
+        if (r.subtree_end > id + 1) {
+            out << ",\"children\":[\n";
+            open.push_back(r.subtree_end);
+            first = true;
+            continue;
+        }
+        out << "}";
+        first = false;
+        while (!open.empty() && open.back() == id + 1) {
+            open.pop_back();
+            out << "\n" << std::string(open.size() * 2, ' ') << "]}";
+        }
+    }
+    out << "\n}\n";
+}
+
+template <typename T>
+void writeRaw(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeBinary(std::ostream& out, const RecordBuilder& builder) {
+    ASTExportHeader header{};
+    std::memcpy(header.magic, "NYTASTX", 8);
+    header.format = AST_EXPORT_FORMAT;
+    header.node_count = static_cast<uint32_t>(builder.records.size());
+    header.string_count = static_cast<uint32_t>(builder.strings.size());
+    header.function_count = static_cast<uint32_t>(builder.functions.size());
+    header.nodes_offset = sizeof(ASTExportHeader);
+    header.strings_offset = header.nodes_offset + builder.records.size() * sizeof(ASTExportRecord);
+    uint64_t string_bytes = 0;
+    for (auto& s : builder.strings) string_bytes += s.size();
+    header.functions_offset = header.strings_offset + (builder.strings.size() + 1) * sizeof(uint64_t) + string_bytes;
+
+    writeRaw(out, header);
+    out.write(reinterpret_cast<const char*>(builder.records.data()), builder.records.size() * sizeof(ASTExportRecord));
+    uint64_t offset = 0;
+    for (auto& s : builder.strings) {
+        writeRaw(out, offset);
+        offset += s.size();
+    }
+    writeRaw(out, offset); // End of the last string
+    for (auto& s : builder.strings) out.write(s.data(), s.size());
+    out.write(reinterpret_cast<const char*>(builder.functions.data()), builder.functions.size() * sizeof(ASTExportFunction));
+}
+
+} // namespace
+
+void exportAST(const ProgramNode& program, const std::string& path, const ASTExportOptions& options) {
+    RecordBuilder builder(options);
+    builder.add(program, 0);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Could not open AST export file: " + path);
+    if (options.format == ASTExportFormat::JSON) writeJSON(out, builder);
+    else writeBinary(out, builder);
+    if (!out) throw std::runtime_error("Could not write AST export file: " + path);
+}
@@ -1,13 +1,43 @@
 #include "code_generator.hpp"
 #include <stdexcept>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <type_traits>
+#include <cstring>
+#include <cstdint>
+
+// Exact IEEE bit pattern of a constant as a NASM hex literal, so .data never goes
+// through a decimal round trip
+static std::string hexBits(uint64_t bits, int bytes) {
+    std::stringstream ss;
+    ss << "0x" << std::hex << std::setw(bytes * 2) << std::setfill('0') << bits;
+    return ss.str();
+}
+
+static std::string floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return hexBits(bits, 4);
+}
+
+static std::string doubleBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return hexBits(bits, 8);
+}
 
 CodeGenerator::CodeGenerator(std::unique_ptr<ProgramNode>& ast, SymbolTable& symTable)
 : program_ast(ast), symbolTable(symTable), string_label_counter(0) {}
 
 void CodeGenerator::generate(const std::string& output_filename, bool is_entry_point) {
+    begin(output_filename, is_entry_point, false);
+    visit(program_ast.get());
+    finish();
+}
+
+void CodeGenerator::begin(const std::string& output_filename, bool is_entry_point, bool stream) {
+    streaming = stream;
     out.open(output_filename);
     if (!out.is_open()) {
         throw std::runtime_error("Could not open output file: " + output_filename);
@@ -24,9 +54,9 @@ void CodeGenerator::generate(const std::string& output_filename, bool is_entry_p
     out << "extern strcmp" << std::endl;
     if (is_entry_point) out << "global _start" << std::endl;
 
-    for (const auto& func : program_ast->functions) {
-        if (!func->body_statements.empty()) out << "global " << func->name << std::endl;
-	    else out << "extern " << func->name << std::endl;
+    // A streamed function's body isn't parsed yet, generateFunction declares it instead
+    if (!streaming) {
+        for (const auto& func : program_ast->functions) declareFunction(func.get());
     }
 
     // entry point
@@ -38,105 +68,46 @@ void CodeGenerator::generate(const std::string& output_filename, bool is_entry_p
 	    out << "  syscall" << std::endl;
     }
 
-    visit(program_ast.get());
+    if (streaming) {
+        for (const auto& stmt : program_ast->statements) {
+            visit(stmt.get());
+        }
+        flushConstants();
+    }
+}
+
+void CodeGenerator::declareFunction(const FunctionDefinitionNode* func) {
+    if (!func->body_statements.empty()) out << "global " << spelling(func->name) << std::endl;
+    else out << "extern " << spelling(func->name) << std::endl;
+}
+
+void CodeGenerator::generateFunction(FunctionDefinitionNode* func) {
+    declareFunction(func);
+    visit(func);
+    flushConstants();
+}
 
-    // print the .data section
+// Writes out the pending .data entries. NASM takes any number of section switches, so a
+// streamed file flushes after every function and the constants don't pile up.
+void CodeGenerator::flushConstants() {
+    if (constants.empty()) return;
     out << "\nsection .data" << std::endl;
     for (const auto& c : constants) {
+        if (c.align > 1) out << "    align " << c.align << ", db 0" << std::endl;
         out << "    " << c.label << " " << c.type << " " << c.value << std::endl;
     }
+    constants.clear();
+    constants_map.clear(); // Labels stay unique, string_label_counter keeps counting
+    if (streaming) out << "\nsection .text" << std::endl;
+}
 
+void CodeGenerator::finish() {
+    flushConstants(); // print the .data section
     out.close();
 }
 
 void CodeGenerator::visit(ASTNode* node) {
-    if (!node) return;
-
-    switch (node->node_type) {
-        case ASTNode::NodeType::PROGRAM:
-            visit(static_cast<ProgramNode*>(node));
-            break;
-        case ASTNode::NodeType::FUNCTION_DEFINITION:
-            visit(static_cast<FunctionDefinitionNode*>(node));
-            break;
-        case ASTNode::NodeType::NAMESPACE_DEFINITION:
-            visit(static_cast<NamespaceDefinition*>(node));
-            break;
-        case ASTNode::NodeType::SCOPE_RESOLUTION:
-            visit(static_cast<ScopeResolutionNode*>(node));
-            break;
-        case ASTNode::NodeType::VARIABLE_DECLARATION:
-            visit(static_cast<VariableDeclarationNode*>(node));
-            break;
-        case ASTNode::NodeType::VARIABLE_ASSIGNMENT:
-            visit(static_cast<VariableAssignmentNode*>(node));
-            break;
-        case ASTNode::NodeType::VARIABLE_REFERENCE:
-            visit(static_cast<VariableReferenceNode*>(node));
-            break;
-        case ASTNode::NodeType::BINARY_OPERATION_EXPRESSION:
-            visit(static_cast<BinaryOperationExpressionNode*>(node));
-            break;
-        case ASTNode::NodeType::PRINT_STATEMENT:
-            visit(static_cast<PrintStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::RETURN_STATEMENT:
-            visit(static_cast<ReturnStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::IF_STATEMENT:
-            visit(static_cast<IfStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::WHILE_STATEMENT:
-            visit(static_cast<WhileStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::FOR_STATEMENT:
-            visit(static_cast<ForStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::FUNCTION_CALL:
-            visit(static_cast<FunctionCallNode*>(node));
-            break;
-        case ASTNode::NodeType::MEMBER_ACCESS_EXPRESSION:
-            visit(static_cast<MemberAccessNode*>(node));
-            break;
-        case ASTNode::NodeType::UNARY_OP_EXPRESSION:
-            visit(static_cast<UnaryOpExpressionNode*>(node));
-            break;
-        case ASTNode::NodeType::ARRAY_ACCESS_EXPRESSION:
-            visit(static_cast<ArrayAccessNode*>(node));
-            break;
-        case ASTNode::NodeType::STRUCT_DEFINITION:
-            visit(static_cast<StructDefinitionNode*>(node));
-            break;
-        case ASTNode::NodeType::INTEGER_LITERAL_EXPRESSION:
-            visit(static_cast<IntegerLiteralExpressionNode*>(node));
-            break;
-        case ASTNode::NodeType::STRING_LITERAL_EXPRESSION:
-            visit(static_cast<StringLiteralExpressionNode*>(node));
-            break;
-        case ASTNode::NodeType::BOOLEAN_LITERAL_EXPRESSION:
-            visit(static_cast<BooleanLiteralExpressionNode*>(node));
-            break;
-        case ASTNode::NodeType::CHARACTER_LITERAL_EXPRESSION:
-            visit(static_cast<CharacterLiteralExpressionNode*>(node));
-            break;
-        case ASTNode::NodeType::FLOAT_LITERAL_EXPRESSION:
-            visit(static_cast<FloatLiteralExpressionNode*>(node));
-            break;
-        case ASTNode::NodeType::DOUBLE_LITERAL_EXPRESSION:
-            visit(static_cast<DoubleLiteralExpressionNode*>(node));
-            break;
-        case ASTNode::NodeType::ASM_STATEMENT:
-            visit(static_cast<AsmStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::CONSTANT_DECLARATION:
-            visit(static_cast<ConstantDeclarationNode*>(node));
-            break;
-        case ASTNode::NodeType::ENUM_STATEMENT:
-            visit(static_cast<EnumStatementNode*>(node));
-            break;
-        default:
-            throw std::runtime_error("Code Generation Error: Unknown AST node type.");
-    }
+    if (node) dispatch(node);
 }
 
 bool is_lvalue;
@@ -176,9 +147,8 @@ void CodeGenerator::visit(FunctionDefinitionNode* node) {
 
     out.std::ios::rdbuf(backup);
 
-    // Calculate total local variable space from current scope
-    int local_var_space = 0;
-    if (!symbolTable.all_scopes.empty()) local_var_space = -symbolTable.all_scopes.back()->currentOffset;
+    // Local variable space over all of the function's scopes, as the analyzer measured it
+    int local_var_space = node->frame_size;
     if (local_var_space == 0) local_var_space = 64;
 
     int aligned_space = (local_var_space + 15) & ~15;
@@ -216,21 +186,7 @@ void CodeGenerator::visit(NamespaceDefinition* node) {
 }
 
 void CodeGenerator::visit(ScopeResolutionNode* node) {
-    Symbol* ns_symbol = symbolTable.lookup(node->namespace_name);
-    if (ns_symbol && ns_symbol->internal_scope) {
-        auto it = ns_symbol->internal_scope->symbols.find(node->member->get_value());
-        if (it != ns_symbol->internal_scope->symbols.end()) {
-            Symbol& sym = it->second;
-            if (sym.dataType) {
-                node->member->resolved_type = sym.dataType->clone();
-                if (node->member->node_type == ASTNode::NodeType::VARIABLE_REFERENCE) {
-                    auto* var = static_cast<VariableReferenceNode*>(node->member.get());
-                    var->resolved_symbol = &sym;
-                }
-            }
-        }
-    }
-    visit(node->member.get());
+    visit(node->member.get()); // Bound to the namespace's symbol by the semantic analyzer
 }
 
 void CodeGenerator::visit(ConstantDeclarationNode* node) {
@@ -242,31 +198,42 @@ void CodeGenerator::visit(EnumStatementNode* node) {
 }
 
 void CodeGenerator::visit(VariableDeclarationNode* node) {
-    auto prim = static_cast<PrimitiveTypeNode*>(node->type.get());
+    auto prim = static_cast<const PrimitiveTypeNode*>(node->type);
     bool is_float = prim && (prim->primitive_type == Token::KEYWORD_FLOAT);
     bool is_double = prim && (prim->primitive_type == Token::KEYWORD_DOUBLE);
-    int size = getTypeSize(node->type.get());
+    int size = typeSize(node->type);
+    int align = std::max(typeAlign(node->type), node->align);
     std::string asm_label;
     for (auto& decl : node->declarations) {
         Symbol* symbol = decl.resolved_symbol;
-        if (!symbol) throw std::runtime_error("Code generation error: variable '" + decl.name + "' not found in symbol table.");
+        if (!symbol) throw std::runtime_error("Code generation error: variable '" + spelling(decl.name) + "' not found in symbol table.");
 
-        std::string final_name = symbol->mangled_name;
+        Ident label = symbolTable.label(*symbol);
 
-        if (!final_name.empty() && final_name != decl.name) {
+        if (label != NO_IDENT) {
+            const std::string& final_name = spelling(label);
             std::string init_val = "0";
             bool has_non_const_init = false;
 
             if (decl.initial_value) {
-                if (decl.initial_value->is_constant()) {
-                    init_val = decl.initial_value->get_value();
+                ASTNode* init = decl.initial_value.get();
+                if (init->node_type == ASTNode::NodeType::FLOAT_LITERAL_EXPRESSION && (size == 4 || size == 8)) {
+                    float value = static_cast<FloatLiteralExpressionNode*>(init)->value;
+                    init_val = size == 4 ? floatBits(value) : doubleBits(value);
+                } else if (init->node_type == ASTNode::NodeType::DOUBLE_LITERAL_EXPRESSION && (size == 4 || size == 8)) {
+                    double value = static_cast<DoubleLiteralExpressionNode*>(init)->value;
+                    init_val = size == 4 ? floatBits(static_cast<float>(value)) : doubleBits(value);
+                } else if (init->is_constant()) {
+                    init_val = init->get_value();
                 } else {
                     has_non_const_init = true;
                 }
             }
 
-            std::string nasm_type = (size == 4) ? "dd" : (size == 8) ? "dq" : (size == 1) ? "db" : "dw";
-            constants.push_back({final_name, nasm_type, init_val});
+            // Structs and arrays get all of their bytes, zeroed
+            std::string nasm_type = (size == 4) ? "dd" : (size == 8) ? "dq" : (size == 1) ? "db" : (size == 2) ? "dw"
+                                  : "times " + std::to_string(size) + " db";
+            constants.push_back({final_name, nasm_type, init_val, align});
 
             if (has_non_const_init) {
                 visit(decl.initial_value.get());
@@ -293,13 +260,14 @@ void CodeGenerator::visit(VariableAssignmentNode* node) {
 
     visit(node->right.get());
     auto* var_ref = dynamic_cast<VariableReferenceNode*>(node->left.get());
-    if (var_ref && !var_ref->resolved_symbol->mangled_name.empty()) {
-        std::string label = var_ref->resolved_symbol->mangled_name;
+    Ident label_ident = var_ref ? symbolTable.label(*var_ref->resolved_symbol) : NO_IDENT;
+    if (label_ident != NO_IDENT) {
+        const std::string& label = spelling(label_ident);
         if (is_fp) {
-            std::string instr = (getTypeSize(type.get()) == 4) ? "vmovss" : "vmovsd";
+            std::string instr = (typeSize(type) == 4) ? "vmovss" : "vmovsd";
             out << "    " << instr << " [rel " << label << "], xmm0" << std::endl;
         } else {
-            int size = getTypeSize(node->left->resolved_type.get());
+            int size = typeSize(node->left->resolved_type);
             if (size == 4) {
                 emit("mov", "dword [rel " + label + "]", "eax");
             } else if (size == 1) {
@@ -332,29 +300,29 @@ void CodeGenerator::visit(VariableReferenceNode* node) {
     int offset = symbol->offset;
 
     if (!node->resolved_symbol) {
-        throw std::runtime_error("CodeGen Error: Symbol not resolved for " + node->name);
+        throw std::runtime_error("CodeGen Error: Symbol not resolved for " + spelling(node->name));
     }
     if (!node->resolved_symbol->dataType) {
-        throw std::runtime_error("CodeGen Error: Variable '" + node->name + "' has NO TYPE in symbol table!");
+        throw std::runtime_error("CodeGen Error: Variable '" + spelling(node->name) + "' has NO TYPE in symbol table!");
     }
 
     if (!symbol) {
-        throw std::runtime_error("CodeGen Error: Reference to '" + node->name + "' not resolved.");
+        throw std::runtime_error("CodeGen Error: Reference to '" + spelling(node->name) + "' not resolved.");
     }
 
     if (symbol->type == Symbol::SymbolType::CONSTANT) {
-        visit(symbol->value.get());
+        visit(symbolTable.constant(*symbol).value.get());
         return;
     }
 
-    auto prim = dynamic_cast<PrimitiveTypeNode*>(node->resolved_type.get());
+    auto prim = dynamic_cast<const PrimitiveTypeNode*>(node->resolved_type);
     bool is_double = prim && (prim->primitive_type == Token::KEYWORD_DOUBLE);
     bool is_float = prim && (prim->primitive_type == Token::KEYWORD_FLOAT);
-    bool is_global = !symbol->mangled_name.empty() && symbol->mangled_name != symbol->name;
+    Ident label = symbolTable.label(*symbol);
 
-    if (is_global) {
-        std::string asm_label = symbol->mangled_name;
-        int size = getTypeSize(node->resolved_type.get());
+    if (label != NO_IDENT) {
+        const std::string& asm_label = spelling(label);
+        int size = typeSize(node->resolved_type);
 
         if (is_lvalue) {
             out << "    lea rax, [rel " << asm_label << "]" << std::endl;
@@ -384,13 +352,13 @@ void CodeGenerator::visit(BinaryOperationExpressionNode* node) {
     bool is_double = false;
 
     if (node->resolved_type->category == TypeNode::TypeCategory::PRIMITIVE) {
-        auto prim = std::static_pointer_cast<PrimitiveTypeNode>(node->resolved_type);
+        auto prim = static_cast<const PrimitiveTypeNode*>(node->resolved_type);
         is_float = (prim->primitive_type == Token::KEYWORD_FLOAT || prim->primitive_type == Token::FLOAT_LITERAL);
         is_double = (prim->primitive_type == Token::KEYWORD_DOUBLE || prim->primitive_type == Token::DOUBLE_LITERAL);
     }
     if (debug_mode) {
         if (node->resolved_type->category == TypeNode::TypeCategory::PRIMITIVE) {
-            auto prim = std::static_pointer_cast<PrimitiveTypeNode>(node->resolved_type);
+            auto prim = static_cast<const PrimitiveTypeNode*>(node->resolved_type);
             std::cout << "Debug: Primitive Type ID found: " << prim->primitive_type << std::endl;
             std::cout << "Debug: Expected FLOAT_LITERAL: " << Token::FLOAT_LITERAL << std::endl;
             std::cout << "Debug: Expected KEYWORD_FLOAT: " << Token::KEYWORD_FLOAT << std::endl;
@@ -439,7 +407,7 @@ void CodeGenerator::visit(BinaryOperationExpressionNode* node) {
 	        emit_binary_op("idiv", type);
             break;
         case Token::EQUAL_EQUAL:
-            if (node->left->resolved_type && node->left->resolved_type->category == TypeNode::TypeCategory::PRIMITIVE && static_cast<PrimitiveTypeNode*>(node->left->resolved_type.get())->primitive_type == Token::KEYWORD_STRING) {
+            if (node->left->resolved_type && node->left->resolved_type->category == TypeNode::TypeCategory::PRIMITIVE && static_cast<const PrimitiveTypeNode*>(node->left->resolved_type)->primitive_type == Token::KEYWORD_STRING) {
                 // String comparison
                 out << "    mov rdi, rcx" << std::endl;
                 out << "    mov rsi, rax" << std::endl;
@@ -455,7 +423,7 @@ void CodeGenerator::visit(BinaryOperationExpressionNode* node) {
             }
             break;
         case Token::BANG_EQUAL:
-            if (node->left->resolved_type && node->left->resolved_type->category == TypeNode::TypeCategory::PRIMITIVE && static_cast<PrimitiveTypeNode*>(node->left->resolved_type.get())->primitive_type == Token::KEYWORD_STRING) {
+            if (node->left->resolved_type && node->left->resolved_type->category == TypeNode::TypeCategory::PRIMITIVE && static_cast<const PrimitiveTypeNode*>(node->left->resolved_type)->primitive_type == Token::KEYWORD_STRING) {
                 // String comparison
                 out << "    mov rdi, rcx" << std::endl;
                 out << "    mov rsi, rax" << std::endl;
@@ -548,12 +516,9 @@ void CodeGenerator::visit(IfStatementNode* node) {
     out << end_label << ":" << std::endl;
 }
 
-void CodeGenerator::visit(SwitchStatementNode* node) { //TODO:
-    if (node->use_jump_table) {
-
-    } else {
-        // normal comp chain
-    }
+void CodeGenerator::visit(SwitchStatementNode* node) {
+    (void)node;
+    throw std::runtime_error("Code Generation Error: switch statements are not supported yet.");
 }
 
 void CodeGenerator::visit(WhileStatementNode* node) {
@@ -613,7 +578,7 @@ void CodeGenerator::visit(FunctionCallNode* node) {
     int arg_count = node->arguments.size();
 
     if (!node->resolved_symbol) {
-        throw std::runtime_error("CodeGen Error: Function " + node->function_name + " not found.");
+        throw std::runtime_error("CodeGen Error: Function " + spelling(node->function_name) + " not found.");
     }
 
     for (int i = arg_count - 1; i >= (int)arg_regs_64.size(); --i) {
@@ -626,14 +591,14 @@ void CodeGenerator::visit(FunctionCallNode* node) {
         visit(node->arguments[i].get());
 
         int size = 8;
-        if (node->arguments[i]->resolved_type) size = getTypeSize(node->arguments[i]->resolved_type.get());
-        else std::cerr << "Warning: Argument " << i << " in call to '" << node->function_name << "' has no resolved type. Defaulting to 8 bytes." << std::endl;
+        if (node->arguments[i]->resolved_type) size = typeSize(node->arguments[i]->resolved_type);
+        else std::cerr << "Warning: Argument " << i << " in call to '" << spelling(node->function_name) << "' has no resolved type. Defaulting to 8 bytes." << std::endl;
 
         if (size == 8) out << "    mov " << arg_regs_64[i] << ", rax" << std::endl;
         else out << "    mov " << arg_regs_32[i] << ", eax" << std::endl;
     }
 
-    std::string target_label = node->resolved_symbol->mangled_name;
+    const std::string& target_label = spelling(symbolTable.label(*node->resolved_symbol));
 
     out << "    call " << target_label << std::endl;
 
@@ -656,10 +621,10 @@ void CodeGenerator::visit(MemberAccessNode* node) {
     }
 
     if (!node->resolved_type) {
-        throw std::runtime_error("CodeGen Error: Member access '" + node->member_name + "' has no resolved type.");
+        throw std::runtime_error("CodeGen Error: Member access '" + spelling(node->member_name) + "' has no resolved type.");
     }
 
-    int size = getTypeSize(node->resolved_type.get());
+    int size = typeSize(node->resolved_type);
 
     if (!is_lvalue) {
         if (size == 4) {
@@ -678,7 +643,7 @@ void CodeGenerator::visit(UnaryOpExpressionNode* node) {
         const auto* ref_node = static_cast<const VariableReferenceNode*>(node->operand.get());
         Symbol* var_symbol = ref_node->resolved_symbol;
         if (!var_symbol) {
-            throw std::runtime_error("Code generation error: variable '" + ref_node->name + "' used before declaration for address-of (resolved_symbol is null).");
+            throw std::runtime_error("Code generation error: variable '" + spelling(ref_node->name) + "' used before declaration for address-of (resolved_symbol is null).");
         }
         int offset = var_symbol->offset;
         out << "    lea rax, [rbp + " << std::to_string(offset) << "]" << std::endl;
@@ -702,8 +667,8 @@ void CodeGenerator::visit(ArrayAccessNode* node) {
     int element_size = 8;
     if (node->array_expr && node->array_expr->resolved_type) {
         if (node->array_expr->resolved_type->category == TypeNode::TypeCategory::ARRAY) {
-            auto arr_type = static_cast<ArrayTypeNode*>(node->array_expr->resolved_type.get());
-            element_size = getTypeSize(arr_type->base_type.get());
+            auto arr_type = static_cast<const ArrayTypeNode*>(node->array_expr->resolved_type);
+            element_size = typeSize(arr_type->base_type);
         }
     }
 
@@ -739,13 +704,11 @@ void CodeGenerator::visit(StructDefinitionNode* node) {
 void CodeGenerator::visit(IntegerLiteralExpressionNode* node) {
     out << "    mov rax, " << node->value << std::endl;
 
-    if (!node->resolved_type) node->resolved_type = std::make_shared<PrimitiveTypeNode>(Token::KEYWORD_INT);
+    if (!node->resolved_type) node->resolved_type = primitiveType(Token::KEYWORD_INT);
 }
 
 void CodeGenerator::visit(FloatLiteralExpressionNode* node) {
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(6) << node->value;
-    std::string val_str = ss.str();
+    std::string val_str = floatBits(node->value);
 
     if (constants_map.find(val_str) == constants_map.end()) {
         std::string label = "_float_" + std::to_string(string_label_counter++);
@@ -757,9 +720,7 @@ void CodeGenerator::visit(FloatLiteralExpressionNode* node) {
 }
 
 void CodeGenerator::visit(DoubleLiteralExpressionNode* node) {
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(15) << node->value;
-    std::string val_str = ss.str();
+    std::string val_str = doubleBits(node->value);
 
     if (constants_map.find(val_str) == constants_map.end()) {
         std::string label = "_double_" + std::to_string(string_label_counter++);
@@ -780,7 +741,7 @@ void CodeGenerator::visit(StringLiteralExpressionNode* node) {
 
     std::string label = constants_map[formatted_val];
     out << "    lea rax, [rel " << label << "]" << std::endl;
-    node->resolved_type = std::make_shared<PrimitiveTypeNode>(Token::KEYWORD_STRING);
+    node->resolved_type = primitiveType(Token::KEYWORD_STRING);
 }
 
 void CodeGenerator::visit(BooleanLiteralExpressionNode* node) {
@@ -789,7 +750,7 @@ void CodeGenerator::visit(BooleanLiteralExpressionNode* node) {
 
 void CodeGenerator::visit(CharacterLiteralExpressionNode* node) {
     out << "    mov rax, " << static_cast<int>(node->value) << std::endl;
-    if (!node->resolved_type) node->resolved_type = std::make_shared<PrimitiveTypeNode>(Token::KEYWORD_BOOL);
+    if (!node->resolved_type) node->resolved_type = primitiveType(Token::KEYWORD_BOOL);
 }
 
 void CodeGenerator::visit(AsmStatementNode* node) {
@@ -798,53 +759,3 @@ void CodeGenerator::visit(AsmStatementNode* node) {
     }
 }
 
-int CodeGenerator::getTypeSize(const TypeNode* type) {
-    if (!type) {
-        std::cerr << "Type is null" << std::endl;
-        throw std::runtime_error("Code Generation Error: Attempted to get size of a null type.");
-    }
-
-    switch (type->category) {
-        case TypeNode::TypeCategory::PRIMITIVE: {
-            const PrimitiveTypeNode* prim_type = static_cast<const PrimitiveTypeNode*>(type);
-            switch (prim_type->primitive_type) {
-                case Token::KEYWORD_INT: return 4;
-                case Token::KEYWORD_BOOL: return 1;
-                case Token::KEYWORD_CHAR: return 1;
-                case Token::KEYWORD_STRING: return 8;
-                case Token::KEYWORD_VOID: return 0;
-                case Token::KEYWORD_FLOAT: return 4;
-                case Token::KEYWORD_DOUBLE: return 8;
-                default: throw std::runtime_error("Code Generation Error: Unknown primitive type (" + std::to_string((int)prim_type->primitive_type) + ") for size calculation. (Type category: " + std::to_string((int)type->category) + ")");
-            }
-        }
-        case TypeNode::TypeCategory::POINTER: return 8;
-        case TypeNode::TypeCategory::ARRAY: {
-            const ArrayTypeNode* array_type = static_cast<const ArrayTypeNode*>(type);
-            int element_size = getTypeSize(array_type->base_type.get());
-            if (array_type->size > 0) {
-                return element_size * array_type->size;
-            }
-            return 0;
-        }
-        case TypeNode::TypeCategory::STRUCT: {
-            const StructTypeNode* struct_type = static_cast<const StructTypeNode*>(type);
-            Symbol* struct_def_symbol = symbolTable.lookup(struct_type->struct_name);
-             if (!struct_def_symbol || !struct_def_symbol->structDef) {
-                const auto& structs = symbolTable.getStructDefinitions();
-                if (structs.count(struct_type->struct_name)) {
-                    auto struct_ptr = structs.at(struct_type->struct_name);
-                    if (struct_ptr) {
-                        return struct_ptr->size;
-                    } else {
-                        std::cout << "CRITICAL: Struct '" << struct_type->struct_name 
-                                << "' exists in registry but pointer is NULL!" << std::endl;
-                    }
-                }
-                 throw std::runtime_error("Code Generation Error: Undefined struct '" + struct_type->struct_name + "'.");
-              }
-              return struct_def_symbol->structDef->size;
-          }
-          default: throw std::runtime_error("Code Generation Error: Unknown type category for size calculation.");
-    }
-}
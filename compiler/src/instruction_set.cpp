@@ -14,8 +14,8 @@ void CodeGenerator::emit(const std::string& instr, const std::string& dest, cons
     out << "    " << instr << " " << dest << ", " << src << std::endl;
 }
 
-void CodeGenerator::emit_adv(const std::shared_ptr<TypeNode>& type, const std::string& base_reg, int offset, const std::string& src_val) {
-    int size = getTypeSize(type.get());
+void CodeGenerator::emit_adv(const TypeNode* type, const std::string& base_reg, int offset, const std::string& src_val) {
+    int size = typeSize(type);
     bool is_fp = isFloatingPoint(type);
     std::string size_prefix = (size == 1) ? "byte" : (size == 4) ? "dword" : "qword";
 
@@ -37,31 +37,6 @@ void CodeGenerator::emit_adv(const std::shared_ptr<TypeNode>& type, const std::s
     }
 }
 
-void CodeGenerator::emit_adv(const std::unique_ptr<TypeNode>& type, const std::string& base_reg, int offset, const std::string& src_val) {
-    int size = getTypeSize(type.get());
-    auto prim = dynamic_cast<PrimitiveTypeNode*>(type.get());
-    bool is_double = prim && (prim->primitive_type == Token::KEYWORD_DOUBLE);
-    bool is_float = prim && (prim->primitive_type == Token::KEYWORD_FLOAT);
-    std::string size_prefix = (size == 1) ? "byte" : (size == 4) ? "dword" : "qword";
-
-    if (is_float || is_double) {
-        std::string instr = (size == 4) ? "vmovss" : "vmovsd";
-        out << "    " << instr << " [" << base_reg << " + " << offset << "], " << src_val << std::endl;
-    } else {
-	std::string final_src = src_val;
-
-        if (src_val == "rbx") {
-            if (size == 1) final_src = "bl";
-            else if (size == 4) final_src = "ebx";
-        } else if (src_val == "rax") {
-            if (size == 1) final_src = "al";
-            else if (size == 4) final_src = "eax";
-        }
-
-        out << "    mov " << size_prefix << " [" << base_reg << " + " << offset << "], " << final_src << std::endl;
-    }
-}
-
 void CodeGenerator::call_external(const std::string& func_name) {
     bool misaligned = (current_stack_depth % 16 != 0);
 
@@ -72,9 +47,9 @@ void CodeGenerator::call_external(const std::string& func_name) {
     if (misaligned) emit("add", "rsp", "8");
 }
 
-void CodeGenerator::emit_print(const std::shared_ptr<TypeNode>& type) {
-    auto prim = dynamic_cast<PrimitiveTypeNode*>(type.get());
-    int size = getTypeSize(type.get());
+void CodeGenerator::emit_print(const TypeNode* type) {
+    auto prim = dynamic_cast<const PrimitiveTypeNode*>(type);
+    int size = typeSize(type);
 
     if (isFloatingPoint(type)) {
         if (size == 4) emit("cvtss2sd", "xmm0", "xmm0");
@@ -117,9 +92,9 @@ void CodeGenerator::emit_binary_op(const std::string& op_instr, char type) {
     }
 }
 
-void CodeGenerator::load_adv(const std::shared_ptr<TypeNode>& type, const std::string& dest_reg, const std::string base_reg, int offset) {
+void CodeGenerator::load_adv(const TypeNode* type, const std::string& dest_reg, const std::string base_reg, int offset) {
     bool is_fp = isFloatingPoint(type);
-    int size = getTypeSize(type.get());
+    int size = typeSize(type);
     std::string off_str = std::to_string(offset);
 
     if (is_fp) {
@@ -132,26 +107,9 @@ void CodeGenerator::load_adv(const std::shared_ptr<TypeNode>& type, const std::s
     }
 }
 
-void CodeGenerator::load_adv(const std::unique_ptr<TypeNode>& type, const std::string& dest_reg, const std::string& base_reg, int offset) {
-    auto prim = dynamic_cast<PrimitiveTypeNode*>(type.get());
-    bool is_double = prim && (prim->primitive_type == Token::KEYWORD_DOUBLE);
-    bool is_float = prim && (prim->primitive_type == Token::KEYWORD_FLOAT);
-    int size = getTypeSize(type.get());
-    std::string off_str = std::to_string(offset);
-
-    if (is_float || is_double) {
-	if (size == 4) emit("vmovss", dest_reg, "[" + base_reg + " + " + off_str + "]");
-	else emit("vmovsd", dest_reg, "[" + base_reg + "+" + off_str + "]");
-    } else {
-	if (size == 1) emit("movsx", dest_reg, "byte [" + base_reg + " + " + off_str + "]");
-	else if (size == 4) emit("movsx", dest_reg, "dword [" + base_reg + " + " + off_str + "]");
-	else emit("mov", dest_reg, "[" + base_reg + " + " + off_str + "]");
-    }
-}
-
-bool CodeGenerator::isFloatingPoint(const std::shared_ptr<TypeNode>& type) {
+bool CodeGenerator::isFloatingPoint(const TypeNode* type) {
     if (!type) return false;
-    auto prim = dynamic_cast<PrimitiveTypeNode*>(type.get());
+    auto prim = dynamic_cast<const PrimitiveTypeNode*>(type);
     return prim && (prim->primitive_type == Token::KEYWORD_FLOAT || 
                     prim->primitive_type == Token::KEYWORD_DOUBLE);
 }
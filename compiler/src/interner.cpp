@@ -0,0 +1,26 @@
+#include "interner.hpp"
+
+Interner& Interner::global() {
+    static Interner instance;
+    return instance;
+}
+
+Interner::Interner() {
+    intern(""); // NO_IDENT
+}
+
+Ident Interner::intern(std::string_view text) {
+    auto it = ids.find(text);
+    if (it != ids.end()) return it->second;
+
+    const std::string& stored = storage.emplace_back(text);
+    Ident id = static_cast<Ident>(spellings.size());
+    spellings.push_back(&stored);
+    ids.emplace(std::string_view(stored), id);
+    return id;
+}
+
+Ident Interner::find(std::string_view text) const {
+    auto it = ids.find(text);
+    return it != ids.end() ? it->second : NO_IDENT;
+}
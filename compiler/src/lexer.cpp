@@ -1,25 +1,104 @@
 #include "lexer.hpp"
+#include "scan.hpp"
+#include "char_class.hpp"
 #include <iostream>
-#include <cctype>
-#include <unordered_map>
-
-static const std::unordered_map<std::string, Token::Type> KEYWORD_MAP = {
-    {"return", Token::KEYWORD_RETURN}, {"int", Token::KEYWORD_INT},
-    {"string", Token::KEYWORD_STRING}, {"print", Token::KEYWORD_PRINT},
-    {"if", Token::KEYWORD_IF},         {"else", Token::KEYWORD_ELSE},
-    {"while", Token::KEYWORD_WHILE},   {"bool", Token::KEYWORD_BOOL},
-    {"char", Token::KEYWORD_CHAR},     {"true", Token::TRUE},
-    {"false", Token::FALSE},           {"for", Token::KEYWORD_FOR},
-    {"struct", Token::KEYWORD_STRUCT}, {"switch", Token::KEYWORD_SWITCH},
-    {"case", Token::KEYWORD_CASE},     {"default", Token::KEYWORD_DEFAULT},
-    {"asm", Token::KEYWORD_ASM},       {"enum", Token::KEYWORD_ENUM},
-    {"const", Token::KEYWORD_CONST},   {"public", Token::KEYWORD_PUBLIC},
-    {"private", Token::KEYWORD_PRIVATE}, {"extern", Token::KEYWORD_EXTERN},
-    {"auto", Token::KEYWORD_AUTO},     {"void", Token::KEYWORD_VOID},
-    {"float", Token::KEYWORD_FLOAT},    {"double", Token::KEYWORD_DOUBLE},
-    {"namespace", Token::KEYWORD_NAMESPACE}
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <charconv>
+#include <cstring>
+#include <array>
+#include <cstdint>
+
+// Keyword recognition, generated at compile time from TOKEN_LIST.
+// Keywords are exactly the entries spelled as a lowercase word, labels ("ID", "EOF") and
+// operators never are. They go into a small perfect hash table so classifying an
+// identifier costs one hash of three bytes and at most one compare, no allocation.
+namespace {
+struct KeywordEntry {
+    std::string_view text;
+    Token::Type type;
 };
 
+constexpr KeywordEntry ALL_TOKENS[] = {
+#define AS_ENTRY(name, str) {str, Token::name},
+    TOKEN_LIST(AS_ENTRY)
+#undef AS_ENTRY
+};
+
+constexpr bool isKeywordSpelling(std::string_view text) {
+    if (text.empty()) return false;
+    for (char c : text) {
+        if (c < 'a' || c > 'z') return false;
+    }
+    return true;
+}
+
+constexpr size_t countKeywords() {
+    size_t count = 0;
+    for (const auto& entry : ALL_TOKENS) {
+        if (isKeywordSpelling(entry.text)) count++;
+    }
+    return count;
+}
+
+constexpr size_t KEYWORD_COUNT = countKeywords();
+constexpr size_t KEYWORD_TABLE_SIZE = 64; // Power of two, keep it at least ~2x KEYWORD_COUNT
+static_assert(KEYWORD_COUNT * 2 <= KEYWORD_TABLE_SIZE, "Too many keywords for the perfect hash table, grow KEYWORD_TABLE_SIZE.");
+
+constexpr uint32_t keywordHash(std::string_view text, uint32_t seed) {
+    uint32_t h = seed;
+    h = h * 31 + static_cast<unsigned char>(text[0]);
+    h = h * 31 + static_cast<unsigned char>(text[text.size() / 2]);
+    h = h * 31 + static_cast<unsigned char>(text[text.size() - 1]);
+    h = h * 31 + static_cast<uint32_t>(text.size());
+    return (h ^ (h >> 7)) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+constexpr bool seedIsPerfect(uint32_t seed) {
+    bool used[KEYWORD_TABLE_SIZE] = {};
+    for (const auto& entry : ALL_TOKENS) {
+        if (!isKeywordSpelling(entry.text)) continue;
+        uint32_t slot = keywordHash(entry.text, seed);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t findKeywordSeed() {
+    for (uint32_t seed = 1; seed < 100000; ++seed) {
+        if (seedIsPerfect(seed)) return seed;
+    }
+    return 0;
+}
+
+constexpr uint32_t KEYWORD_SEED = findKeywordSeed();
+static_assert(KEYWORD_SEED != 0, "No collision-free keyword hash seed found, change keywordHash or KEYWORD_TABLE_SIZE.");
+
+constexpr std::array<KeywordEntry, KEYWORD_TABLE_SIZE> buildKeywordTable() {
+    std::array<KeywordEntry, KEYWORD_TABLE_SIZE> table = {};
+    for (auto& slot : table) slot = {"", Token::IDENTIFIER};
+    for (const auto& entry : ALL_TOKENS) {
+        if (isKeywordSpelling(entry.text)) table[keywordHash(entry.text, KEYWORD_SEED)] = entry;
+    }
+    return table;
+}
+
+constexpr std::array<KeywordEntry, KEYWORD_TABLE_SIZE> KEYWORD_TABLE = buildKeywordTable();
+
+// Returns the keyword's token type, or IDENTIFIER for anything else
+constexpr Token::Type lookupKeyword(std::string_view word) {
+    const KeywordEntry& entry = KEYWORD_TABLE[keywordHash(word, KEYWORD_SEED)];
+    return entry.text == word ? entry.type : Token::IDENTIFIER;
+}
+
+static_assert(lookupKeyword("namespace") == Token::KEYWORD_NAMESPACE);
+static_assert(lookupKeyword("true") == Token::TRUE);
+static_assert(lookupKeyword("ID") == Token::IDENTIFIER);
+static_assert(lookupKeyword("x") == Token::IDENTIFIER);
+} // namespace
+
 // Token type to string conversion
 std::string Token::typeToString() const {
     static const char* typeStrings[] = {
@@ -34,259 +113,388 @@ std::string Token::typeToString() const {
     return "UNKNOWN";
 }
 
-// Lexical analysis - converts source code to tokens
-std::vector<Token> tokenize(const std::string& sourceCode) {
-    std::vector<Token> tokens;
-    int currentPos = 0;
-    int line = 1;
-    int column = 1;
-
-    while (currentPos < sourceCode.length()) {
-        char currentChar = sourceCode[currentPos];
-
-        // Single-line comment
-        if (currentChar == '/' && currentPos + 1 < sourceCode.length() && sourceCode[currentPos + 1] == '/') {
-            currentPos += 2;
-            column += 2;
-            while (currentPos < sourceCode.length() && sourceCode[currentPos] != '\n') {
-                currentPos++;
-                column++;
-            }
-            continue;
+static_assert(lex::TOKEN_COUNT == Token::UNKNOWN + 1, "lex:: token ids must match Token::Type.");
+
+int LineTable::physicalLine(uint32_t offset) const {
+    return static_cast<int>(std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin());
+}
+
+const LineMarker* LineTable::markerFor(uint32_t offset) const {
+    auto it = std::upper_bound(markers.begin(), markers.end(), offset,
+                               [](uint32_t value, const LineMarker& marker) { return value < marker.offset; });
+    return it == markers.begin() ? nullptr : &*(it - 1);
+}
+
+int LineTable::line(uint32_t offset) const {
+    int physical = physicalLine(offset);
+    const LineMarker* marker = markerFor(offset);
+    return marker ? marker->line + (physical - physicalLine(marker->offset)) : physical;
+}
+
+int LineTable::column(uint32_t offset) const {
+    return static_cast<int>(offset - starts[physicalLine(offset) - 1]) + 1;
+}
+
+std::string_view LineTable::file(uint32_t offset) const {
+    const LineMarker* marker = markerFor(offset);
+    return marker ? marker->file : std::string_view();
+}
+
+std::string LineTable::describe(uint32_t offset) const {
+    std::string text = "line " + std::to_string(line(offset)) + ", column " + std::to_string(column(offset));
+    std::string_view in = file(offset);
+    if (!in.empty()) text += " in " + std::string(in);
+    return text;
+}
+
+Lexer::Lexer(std::string_view source) : src(source) {
+    if (source.size() >= UINT32_MAX) {
+        throw std::runtime_error("Lexer Error: Source file is too large (4 GiB limit).");
+    }
+}
+
+Lexer::Lexer(std::string_view source, size_t begin, size_t end, std::vector<LexerDiagnostic>* diagnostics)
+    : src(source.substr(0, end)), currentPos(begin), deferred(diagnostics) {}
+
+void Lexer::report(size_t offset, std::string message) {
+    errors++;
+    if (deferred) {
+        deferred->push_back({static_cast<uint32_t>(offset), std::move(message)});
+        return;
+    }
+    if (!quiet) std::cerr << message << " at " << lines.describe(offset) << std::endl;
+}
+
+// `#line N "file"` at the start of a line, as written by the preprocessor. Records the
+// marker and skips the line; returns false (nothing consumed) for anything else.
+bool Lexer::skipLineMarker() {
+    static constexpr std::string_view directive = "#line ";
+    if ((currentPos > 0 && src[currentPos - 1] != '\n') || src.substr(currentPos, directive.size()) != directive) return false;
+
+    size_t end = findLineEnd(src, currentPos);
+    std::string_view text = src.substr(currentPos + directive.size(), end - currentPos - directive.size());
+    int line = 0;
+    auto [rest, ec] = std::from_chars(text.data(), text.data() + text.size(), line);
+    size_t open = text.find('"', rest - text.data());
+    if (ec != std::errc() || open == std::string_view::npos) return false;
+
+    // The preprocessor puts a backslash before every '"' and backslash in the path
+    size_t close = open + 1;
+    bool escaped = false;
+    for (; close < text.size() && text[close] != '"'; ++close) {
+        if (text[close] == '\\' && close + 1 < text.size()) {
+            escaped = true;
+            ++close;
         }
+    }
+    if (close >= text.size()) return false;
 
-        // Whitespace
-        if (std::isspace(currentChar)) {
-            if (currentChar == '\n') {
-                line++;
-                column = 1;
-            } else {
-                column++;
-            }
+    std::string_view file = text.substr(open + 1, close - open - 1);
+    if (escaped) {
+        std::string name;
+        for (size_t i = 0; i < file.size(); ++i) name += file[i] == '\\' ? file[++i] : file[i];
+        file = lines.keepFile(std::move(name));
+    }
+    lines.addMarker({static_cast<uint32_t>(std::min(end + 1, src.size())), line, file});
+    currentPos = end;
+    return true;
+}
+
+// Numeric literal: decimal, 0x hex or 0b binary integers, and decimal floats with an
+// 'f' (float) or 'd'/no suffix (double). '_' may separate digits. The value is decoded
+// here once, the parser and codegen never look at the digits again.
+RawToken Lexer::lexNumber() {
+    size_t start = currentPos;
+    int base = 10;
+    if (src[currentPos] == '0' && currentPos + 1 < src.length()) {
+        char prefix = src[currentPos + 1] | 0x20; // Lowercase
+        if (prefix == 'x') base = 16;
+        else if (prefix == 'b') base = 2;
+    }
+
+    bool is_real = false;
+    char suffix = 0;
+    if (base != 10) {
+        currentPos = scanIdentifier(src, currentPos + 2);
+    } else {
+        while (currentPos < src.length() &&
+               (lex::classOf(src[currentPos]) == lex::CC_DIGIT || src[currentPos] == '_' || src[currentPos] == '.')) {
+            if (src[currentPos] == '.') is_real = true;
             currentPos++;
+        }
+        if (currentPos < src.length() && (src[currentPos] == 'f' || src[currentPos] == 'd')) {
+            suffix = src[currentPos++];
+            is_real = true;
+        }
+    }
+    size_t length = currentPos - start;
+
+    // Digits without prefix, suffix and separators. A '_' has to sit between two digits:
+    // not first or last, not doubled and not next to the '.'
+    std::string_view body = src.substr(start + (base != 10 ? 2 : 0), length - (base != 10 ? 2 : 0) - (suffix ? 1 : 0));
+    std::string digits;
+    bool misplaced_separator = false;
+    for (size_t i = 0; i < body.size(); ++i) {
+        if (body[i] != '_') {
+            digits += body[i];
             continue;
         }
+        auto isDigit = [&body](size_t j) { return j < body.size() && body[j] != '_' && body[j] != '.'; };
+        if (i == 0 || !isDigit(i - 1) || !isDigit(i + 1)) misplaced_separator = true;
+    }
+    if (misplaced_separator) {
+        report(start, "Lexer Error: Misplaced '_' in numeric literal");
+        digits = "0"; // Reported once, the literal reads as 0
+    }
+    const char* first = digits.data();
+    const char* last = digits.data() + digits.size();
 
-        // Any digit literal
-        if (std::isdigit(currentChar)) {
-            std::string value;
-            int startColumn = column;
-	    while (currentPos < sourceCode.length() && 
-      		  (std::isdigit(sourceCode[currentPos]) || 
-       		   sourceCode[currentPos] == '.' || 
-       		   sourceCode[currentPos] == 'f' || 
-       		   sourceCode[currentPos] == 'd')) {
-    		value += sourceCode[currentPos++];
-    		column++;
-	    }
-
-	    char suffix = value.back(); // last char of value
-
-	    if (value.find('.') != std::string::npos) {
-		    switch (suffix) {
-		        case 'f': tokens.push_back({Token::FLOAT_LITERAL, value, line, startColumn});
-		        break;
-		        case 'd':
-		        default: tokens.push_back({Token::DOUBLE_LITERAL, value, line, startColumn});
-		        break;
-		    }
-	    } else {
-                tokens.push_back({Token::INTEGER_LITERAL, value, line, startColumn});
-	    }
-	    continue;
-	}
+    auto make = [&](Token::Type kind, uint32_t payload) {
+        return RawToken{kind, static_cast<uint32_t>(start), static_cast<uint32_t>(length), payload};
+    };
 
-        // Character literal
-        if (currentChar == '\'') {
-            std::string value;
-            int startColumn = column;
-            currentPos++; column++; // Skip initial quote
-            if (currentPos < sourceCode.length()) {
-                value += sourceCode[currentPos++];
-                column++;
-            }
-            if (currentPos >= sourceCode.length() || sourceCode[currentPos] != '\'') {
-                std::cerr << "Lexer Error: Unclosed or invalid character literal at line " << line << ", column " << startColumn << std::endl;
-            } else {
-                currentPos++; column++; // Skip closing quote
-            }
-            tokens.push_back({Token::CHARACTER_LITERAL, value, line, startColumn});
-            continue;
-        }
+    if (is_real && suffix == 'f') {
+        float value = 0.0f;
+        auto result = std::from_chars(first, last, value, std::chars_format::fixed);
+        if (result.ec != std::errc() || result.ptr != last) report(start, "Lexer Error: Invalid float literal");
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return make(Token::FLOAT_LITERAL, bits);
+    }
+    if (is_real) {
+        double value = 0.0;
+        auto result = std::from_chars(first, last, value, std::chars_format::fixed);
+        if (result.ec != std::errc() || result.ptr != last) report(start, "Lexer Error: Invalid double literal");
+        doubles.push_back(value);
+        return make(Token::DOUBLE_LITERAL, static_cast<uint32_t>(doubles.size() - 1));
+    }
 
-        // String literal
-        if (currentChar == '"') {
-            std::string value;
-            int startColumn = column;
-            currentPos++; column++; // Skip initial quote
-            while (currentPos < sourceCode.length() && sourceCode[currentPos] != '"') {
-                value += sourceCode[currentPos++];
-                column++;
-            }
-            if (currentPos >= sourceCode.length()) {
-                std::cerr << "Lexer Error: Unclosed string literal at line " << line << ", column " << startColumn << std::endl;
-            }
-            else {
-                currentPos++; column++; // Skip closing quote
-            }
-            tokens.push_back({Token::STRING_LITERAL, value, line, startColumn});
-            continue;
-        }
+    uint64_t value = 0;
+    auto result = std::from_chars(first, last, value, base);
+    uint64_t limit = base == 10 ? INT32_MAX : UINT32_MAX; // Hex/binary may spell any 32-bit pattern
+    if (digits.empty() || result.ptr != last || (result.ec != std::errc() && result.ec != std::errc::result_out_of_range)) {
+        report(start, "Lexer Error: Invalid digit in integer literal");
+        value = 0;
+    } else if (result.ec == std::errc::result_out_of_range || value > limit) {
+        report(start, "Lexer Error: Integer literal out of range");
+        value = 0;
+    }
+    return make(Token::INTEGER_LITERAL, static_cast<uint32_t>(value));
+}
 
-        // Identifier or keyword
-	    if (std::isalpha(currentChar) || currentChar == '_') {
-    	    std::string value;
-    	    int startColumn = column;
-    	    while (currentPos < sourceCode.length() && (std::isalnum(sourceCode[currentPos]) || sourceCode[currentPos] == '_')) {
-        	    value += sourceCode[currentPos++];
-        	    column++;
-    	    }
-
-    	    auto it = KEYWORD_MAP.find(value);
-    	    if (it != KEYWORD_MAP.end()) {
-        	    tokens.push_back({it->second, value, line, startColumn});
-    	    } else {
-        	    tokens.push_back({Token::IDENTIFIER, value, line, startColumn});
-    	    }
-    	    continue;
-	}
-
-        // == or =
-        if (currentChar == '=') {
-            if (currentPos + 1 < sourceCode.length() && sourceCode[currentPos + 1] == '=') {
-                tokens.push_back({Token::EQUAL_EQUAL, "==", line, column});
-                currentPos += 2; column += 2;
-            } else {
-                tokens.push_back({Token::EQ, "=", line, column});
-                currentPos++; column++;
-            }
-            continue;
-        }
+// Lexical analysis - scans the next token
+// Every byte is dispatched on its class from lex::CHAR_CLASS, operators run through the
+// operator DFA, so there is no chain of per-character comparisons.
+// No line/column bookkeeping happens here beyond recording where lines start.
+RawToken Lexer::next() {
+    auto make = [](Token::Type kind, size_t offset, size_t length, uint32_t payload = 0) {
+        return RawToken{kind, static_cast<uint32_t>(offset), static_cast<uint32_t>(length), payload};
+    };
 
-        // !=
-        if (currentChar == '!') {
-            if (currentPos + 1 < sourceCode.length() && sourceCode[currentPos + 1] == '=') {
-                tokens.push_back({Token::BANG_EQUAL, "!=", line, column});
-                currentPos += 2; column += 2;
-            } else {
-		tokens.push_back({Token::BANG, "!", line, column});
-                currentPos++; column++;
-            }
-            continue;
-        }
+    while (currentPos < src.length()) {
+        char currentChar = src[currentPos];
 
-        // < or <=
-        if (currentChar == '<') {
-            if (currentPos + 1 < sourceCode.length() && sourceCode[currentPos + 1] == '=') {
-                tokens.push_back({Token::LESS_EQUAL, "<=", line, column});
-                currentPos += 2; column += 2;
-            } else {
-                tokens.push_back({Token::LESS, "<", line, column});
-                currentPos++; column++;
-            }
+        switch (lex::classOf(currentChar)) {
+        case lex::CC_SPACE:
+            currentPos = skipWhitespace(src, currentPos, lines);
             continue;
-        }
 
-        // > or >=
-        if (currentChar == '>') {
-            if (currentPos + 1 < sourceCode.length() && sourceCode[currentPos + 1] == '=') {
-                tokens.push_back({Token::GREATER_EQUAL, ">=", line, column});
-                currentPos += 2; column += 2;
+        // Any digit literal
+        case lex::CC_DIGIT:
+            return lexNumber();
+
+        // Character literal
+        case lex::CC_CHAR_QUOTE: {
+            size_t quote = currentPos;
+            currentPos++; // Skip initial quote
+            size_t start = currentPos;
+            if (currentPos < src.length()) currentPos++;
+            size_t length = currentPos - start;
+            if (currentPos >= src.length() || src[currentPos] != '\'') {
+                report(quote, "Lexer Error: Unclosed or invalid character literal");
             } else {
-                tokens.push_back({Token::GREATER, ">", line, column});
-                currentPos++; column++;
+                currentPos++; // Skip closing quote
             }
-            continue;
+            return make(Token::CHARACTER_LITERAL, quote, currentPos - quote, static_cast<uint32_t>(length));
         }
 
-        // : or ::
-        if (currentChar == ':') {
-            if (currentPos + 1 < sourceCode.length() && sourceCode[currentPos + 1] == ':') {
-                tokens.push_back({Token::DOUBLE_COLON, "::", line, column});
-                currentPos += 2; column += 2;
-            } else {
-                tokens.push_back({Token::COLON, ":", line, column});
-                currentPos++; column++;
+        // String literal
+        case lex::CC_STRING_QUOTE: {
+            size_t quote = currentPos;
+            currentPos++; // Skip initial quote
+            size_t start = currentPos;
+            currentPos = findStringEnd(src, currentPos, lines);
+            if (currentPos >= src.length()) {
+                report(quote, "Lexer Error: Unclosed string literal");
             }
-            continue;
+            size_t length = currentPos - start;
+            if (currentPos < src.length()) currentPos++; // Skip closing quote
+            return make(Token::STRING_LITERAL, quote, currentPos - quote, static_cast<uint32_t>(length));
         }
 
-        // Other single-char tokens
-        if (currentChar == ';') {
-            tokens.push_back({Token::SEMICOLON, ";", line, column});
-            currentPos++; column++; continue;
+        // Identifier or keyword
+        case lex::CC_IDENT: {
+            size_t start = currentPos;
+            currentPos = scanIdentifier(src, currentPos);
+            std::string_view value = src.substr(start, currentPos - start);
+
+            Token::Type keyword = lookupKeyword(value);
+            if (keyword != Token::IDENTIFIER) return make(keyword, start, value.size());
+            return make(Token::IDENTIFIER, start, value.size(), deferred ? NO_IDENT : intern(value)); // Chunks get interned at merge time
         }
 
-        if (currentChar == '+') {
-            tokens.push_back({Token::PLUS, "+", line, column});
-            currentPos++; column++; continue;
-        }
+        // Operators and punctuation, longest match wins
+        case lex::CC_OPERATOR: {
+            uint8_t token = lex::NO_TOKEN;
+            size_t length = lex::matchOperator(src.substr(currentPos), token);
+            if (length == 0) break;
 
-        if (currentChar == '-') {
-            tokens.push_back({Token::MINUS, "-", line, column});
-            currentPos++; column++; continue;
-        }
+            // Single-line comment
+            if (token == lex::LINE_COMMENT) {
+                currentPos = findLineEnd(src, currentPos + length);
+                continue;
+            }
 
-        if (currentChar == '*') {
-            tokens.push_back({Token::STAR, "*", line, column});
-            currentPos++; column++; continue;
+            size_t start = currentPos;
+            currentPos += length;
+            return make(static_cast<Token::Type>(token), start, length);
         }
 
-        if (currentChar == '/') {
-            tokens.push_back({Token::SLASH, "/", line, column});
-            currentPos++; column++; continue;
+        case lex::CC_OTHER:
+            if (currentChar == '#' && skipLineMarker()) continue;
+            break;
         }
 
-        if (currentChar == '(') {
-            tokens.push_back({Token::LPAREN, "(", line, column});
-            currentPos++; column++; continue;
-        }
+        // Unknown character
+        report(currentPos, std::string("Lexer Error: Unknown character '") + currentChar + "'");
+        currentPos++;
+    }
 
-        if (currentChar == ')') {
-            tokens.push_back({Token::RPAREN, ")", line, column});
-            currentPos++; column++; continue;
-        }
+    return make(Token::END_OF_FILE, src.size(), 0);
+}
 
-        if (currentChar == '{') {
-            tokens.push_back({Token::LBRACE, "{", line, column});
-            currentPos++; column++; continue;
-        }
+// Picks up to `chunks` chunk starts for parallel lexing.
+// A chunk may only start right after a newline that the serial lexer would treat as
+// whitespace, so this walks the source jumping between the bytes that can open a
+// string, char literal or comment, and takes the first such newline past each target.
+static std::vector<size_t> findChunkStarts(std::string_view src, unsigned chunks) {
+    std::vector<size_t> starts{0};
+    size_t pos = 0; // Always outside any literal or comment here
+    for (unsigned k = 1; k < chunks && pos < src.size(); ++k) {
+        size_t target = src.size() / chunks * k;
+        while (pos < src.size()) {
+            size_t special = src.find_first_of("\"'/", pos);
+            size_t plainEnd = special == std::string_view::npos ? src.size() : special;
+            if (plainEnd > target) {
+                size_t newline = src.find('\n', std::max(pos, target));
+                if (newline < plainEnd && newline + 1 < src.size()) {
+                    pos = newline + 1;
+                    starts.push_back(pos);
+                    break;
+                }
+            }
+            if (special == std::string_view::npos) {
+                pos = src.size();
+                break;
+            }
 
-        if (currentChar == '}') {
-            tokens.push_back({Token::RBRACE, "}", line, column});
-            currentPos++; column++; continue;
+            // Step over the construct exactly the way Lexer::next() does
+            pos = special + 1;
+            if (src[special] == '"') {
+                size_t close = src.find('"', pos);
+                pos = close == std::string_view::npos ? src.size() : close + 1;
+            } else if (src[special] == '\'') {
+                if (pos < src.size()) pos++;
+                if (pos < src.size() && src[pos] == '\'') pos++;
+            } else if (pos < src.size() && src[pos] == '/') {
+                size_t end = src.find('\n', pos);
+                pos = end == std::string_view::npos ? src.size() : end;
+            }
         }
+    }
+    return starts;
+}
 
-        if (currentChar == '[') {
-            tokens.push_back({Token::LBRACKET, "[", line, column});
-            currentPos++; column++; continue;
-        }
+TokenBuffer tokenize(std::string_view sourceCode, unsigned threads) {
+    size_t chunkCount = std::min<size_t>(threads, sourceCode.size() / MIN_LEX_CHUNK);
+    if (chunkCount <= 1) {
+        Lexer lexer(sourceCode);
+        TokenBuffer tokens(sourceCode);
+        tokens.reserve(sourceCode.size() / 4); // Rough token density of typical source
+        RawToken raw;
+        do {
+            raw = lexer.next();
+            tokens.push(raw);
+        } while (raw.kind != Token::END_OF_FILE);
+        tokens.setLineTable(lexer.takeLineTable());
+        tokens.doublePool() = lexer.takeDoubles();
+        tokens.setErrorCount(lexer.errorCount());
+        return tokens;
+    }
+    if (sourceCode.size() >= UINT32_MAX) {
+        throw std::runtime_error("Lexer Error: Source file is too large (4 GiB limit).");
+    }
 
-        if (currentChar == ']') {
-            tokens.push_back({Token::RBRACKET, "]", line, column});
-            currentPos++; column++; continue;
-        }
+    std::vector<size_t> starts = findChunkStarts(sourceCode, static_cast<unsigned>(chunkCount));
+    starts.push_back(sourceCode.size());
+    chunkCount = starts.size() - 1;
 
-        if (currentChar == '.') {
-            tokens.push_back({Token::DOT, ".", line, column});
-            currentPos++; column++; continue;
+    struct Chunk {
+        TokenBuffer tokens;
+        LineTable lines;
+        std::vector<LexerDiagnostic> diagnostics;
+    };
+    std::vector<Chunk> results(chunkCount);
+
+    auto lexChunk = [&](size_t index) {
+        Chunk& chunk = results[index];
+        Lexer lexer(sourceCode, starts[index], starts[index + 1], &chunk.diagnostics);
+        chunk.tokens.reserve((starts[index + 1] - starts[index]) / 4);
+        bool last = index + 1 == chunkCount;
+        for (RawToken raw = lexer.next(); ; raw = lexer.next()) {
+            if (raw.kind == Token::END_OF_FILE && !last) break; // Just the end of this chunk
+            chunk.tokens.push(raw);
+            if (raw.kind == Token::END_OF_FILE) break;
         }
+        chunk.lines = lexer.takeLineTable();
+        chunk.tokens.doublePool() = lexer.takeDoubles();
+    };
 
-        if (currentChar == ',') {
-            tokens.push_back({Token::COMMA, ",", line, column});
-            currentPos++; column++; continue;
+    std::vector<std::thread> workers;
+    workers.reserve(chunkCount - 1);
+    for (size_t i = 1; i < chunkCount; ++i) workers.emplace_back(lexChunk, i);
+    lexChunk(0);
+    for (std::thread& worker : workers) worker.join();
+
+    // Stitch the chunks together in source order. Interning happens here, serially,
+    // so identifiers get the same ids they would have gotten from a serial lex.
+    size_t total = 0;
+    for (const Chunk& chunk : results) total += chunk.tokens.size();
+    TokenBuffer tokens(sourceCode);
+    tokens.reserve(total);
+    LineTable lines;
+    std::vector<double>& doubles = tokens.doublePool();
+    for (size_t c = 0; c < chunkCount; ++c) {
+        TokenBuffer& part = results[c].tokens;
+        uint32_t doubleBase = static_cast<uint32_t>(doubles.size());
+        for (size_t i = 0; i < part.size(); ++i) {
+            RawToken raw = part.raw(i);
+            if (raw.kind == Token::IDENTIFIER) raw.payload = intern(sourceCode.substr(raw.offset, raw.length));
+            else if (raw.kind == Token::DOUBLE_LITERAL) raw.payload += doubleBase;
+            tokens.push(raw);
         }
-
-        if (currentChar == '&') {
-            tokens.push_back({Token::ADDRESSOF, "&", line, column});
-            currentPos++; column++; continue;
+        doubles.insert(doubles.end(), part.doublePool().begin(), part.doublePool().end());
+        if (c == 0) lines = std::move(results[c].lines);
+        else lines.append(results[c].lines);
+    }
+    size_t errors = 0;
+    for (const Chunk& chunk : results) {
+        for (const LexerDiagnostic& diagnostic : chunk.diagnostics) {
+            std::cerr << diagnostic.message << " at " << lines.describe(diagnostic.offset) << std::endl;
         }
-
-        // Unknown character
-        std::cerr << "Lexer Error: Unknown character '" << currentChar << "' at line " << line << ", column " << column << std::endl;
-        currentPos++; column++;
+        errors += chunk.diagnostics.size();
     }
-
-    tokens.push_back({Token::END_OF_FILE, "", line, column});
+    tokens.setErrorCount(errors);
+    tokens.setLineTable(std::move(lines));
     return tokens;
 }
@@ -6,23 +6,68 @@
 #include <map>
 #include <unordered_map>
 #include <stdexcept>
+#include <optional>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
 
+#include "source_buffer.hpp"
+#include "source_manager.hpp"
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "ast.hpp"
+#include "ast_cache.hpp"
+#include "ast_export.hpp"
 #include "semantic_analyzer.hpp"
 
 #include "code_generator.hpp"
 
-std::string readFileContent(const std::string& filepath) {
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file: " << filepath << std::endl;
-        return "";
+// -stream: compiles a function at a time instead of holding the whole program. The
+// declarations are parsed (function bodies skipped) and analyzed first, then a second
+// parser hands out one function at a time, which is analyzed, generated and flushed,
+// and then freed along with its scopes. Peak memory follows the largest function
+// rather than the whole unit.
+// Returns false, with nothing generated, if the source had lexer errors.
+static bool compileStreaming(std::string_view source, const std::string& output_asm_filename, bool is_entry, bool debug_mode) {
+    Parser declarations_parser{Lexer(source)};
+    std::unique_ptr<ProgramNode> ast_root = declarations_parser.parseDeclarations();
+    SourceManager::global().setLineTable(declarations_parser.takeLineTable());
+    if (declarations_parser.errorCount() > 0) return false; // The whole source was lexed, bodies included
+
+    SymbolTable symbol_table;
+    symbol_table.setDebugMode(debug_mode);
+    SemanticAnalyzer semanticAnalyzer(ast_root, symbol_table);
+    semanticAnalyzer.setIsEntryPoint(is_entry);
+    semanticAnalyzer.analyzeDeclarations();
+    semanticAnalyzer.checkEntryPoint();
+
+    CodeGenerator codeGenerator(ast_root, symbol_table);
+    codeGenerator.begin(output_asm_filename, is_entry, true);
+
+    Parser body_parser{Lexer(source)};
+    body_parser.suppressDiagnostics(); // Printed by the first pass already
+    for (auto& func : ast_root->functions) {
+        ASTArena function_arena; // The body's nodes, gone at the end of the iteration
+        NodePtr<FunctionDefinitionNode> parsed = body_parser.parseNextFunction(function_arena);
+        if (!parsed || parsed->name != func->name) {
+            throw std::runtime_error("Stream Error: Function '" + spelling(func->name) + "' not found in the second pass.");
+        }
+        func->body_statements = std::move(parsed->body_statements);
+
+        SymbolTable::Mark scope_mark = symbol_table.mark();
+        try {
+            semanticAnalyzer.analyzeFunction(func.get());
+            codeGenerator.generateFunction(func.get());
+        } catch (...) {
+            func->body_statements.clear();
+            throw;
+        }
+        func->body_statements.clear();
+        symbol_table.releaseScopes(scope_mark);
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+
+    codeGenerator.finish();
+    return true;
 }
 
 int main(int argc, char* argv[]) {
@@ -41,6 +86,12 @@ int main(int argc, char* argv[]) {
     bool debug_mode = false;
     bool verbose = false;
     bool is_entry = false;
+    bool use_ast_cache = true;
+    bool stream = false;
+    std::optional<ASTExportOptions> ast_export;
+    std::string ast_export_path;
+    unsigned lex_threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned parse_threads = lex_threads;
     for (int i = 1; i < argc; ++i) {
         if (std::string(argv[i]) == "-debug") {
             debug_mode = true;
@@ -48,6 +99,30 @@ int main(int argc, char* argv[]) {
             verbose = true;
         } else if (std::string(argv[i]) == "-entry") {
             is_entry = true;
+        } else if (std::string(argv[i]) == "-no-ast-cache") {
+            use_ast_cache = false;
+        } else if (std::string(argv[i]) == "-stream") {
+            stream = true;
+        } else if (std::string(argv[i]).rfind("--emit-ast=", 0) == 0) {
+            std::string format = argv[i] + 11;
+            if (format != "json" && format != "bin") {
+                std::cerr << "Error: --emit-ast expects json or bin (found: " << format << ")\n";
+                return 2;
+            }
+            if (!ast_export) ast_export.emplace();
+            ast_export->format = format == "json" ? ASTExportFormat::JSON : ASTExportFormat::BINARY;
+        } else if (std::string(argv[i]).rfind("--emit-ast-function=", 0) == 0) {
+            if (!ast_export) ast_export.emplace();
+            std::stringstream names(argv[i] + 20);
+            for (std::string name; std::getline(names, name, ',');) {
+                if (!name.empty()) ast_export->functions.insert(name);
+            }
+        } else if (std::string(argv[i]).rfind("--emit-ast-out=", 0) == 0) {
+            ast_export_path = argv[i] + 15;
+        } else if (std::string(argv[i]).rfind("-lex-threads=", 0) == 0) {
+            lex_threads = std::max(1, std::atoi(argv[i] + 13)); // 1 = always lex serially
+        } else if (std::string(argv[i]).rfind("-parse-threads=", 0) == 0) {
+            parse_threads = std::max(1, std::atoi(argv[i] + 15)); // 1 = always parse serially
         }
     }
 
@@ -57,16 +132,62 @@ int main(int argc, char* argv[]) {
         return 3;
     }
 
-    std::string sourceCode = readFileContent(input_filepath);
-    if (sourceCode.empty()) return 2;
+    // Mapped, not copied. Must stay alive until parsing is done since tokens point into it.
+    SourceBuffer source;
+    if (!source.open(input_filepath)) {
+        std::cerr << "Error: Could not open file: " << input_filepath << std::endl;
+        return 2;
+    }
+    if (source.empty()) return 2;
+    SourceManager::global().setUnit(input_filepath, source.text());
 
     if (verbose) std::cout << "\n--- Processing Source File: " << input_filepath << " ---\n\n";
 
-    std::vector<Token> tokens = tokenize(sourceCode);
-    Parser parser(std::move(tokens));
-    parser.getSymbolTable().setDebugMode(debug_mode);
+    if (stream) {
+        if (ast_export) {
+            std::cerr << "Error: --emit-ast needs the whole AST and can't be combined with -stream\n";
+            return 2;
+        }
+        if (!compileStreaming(source.text(), output_asm_filename, is_entry, debug_mode)) {
+            std::cerr << "Compilation failed with lexer errors. Exiting.\n";
+            return 1;
+        }
+        if (verbose) std::cout << "Successfully generated assembly to '" << output_asm_filename << "'\n";
+        return 0;
+    }
 
-    std::unique_ptr<ProgramNode> ast_root = parser.parse();
+    // An unchanged source is loaded from the AST cache next to it instead of being parsed
+    std::string cache_path = input_filepath + ".astc";
+    uint64_t source_hash = use_ast_cache ? hashSource(source.text()) : 0;
+    std::unique_ptr<ProgramNode> ast_root;
+    if (use_ast_cache) {
+        ast_root = loadASTCache(cache_path, source_hash);
+        if (ast_root && verbose) std::cout << "Loaded AST from cache '" << cache_path << "'\n";
+    }
+
+    if (!ast_root) {
+        // Sources big enough to split are lexed up front on several threads (and their function
+        // bodies parsed on several threads), everything else is streamed straight into the parser
+        std::optional<Parser> parser;
+        if ((lex_threads > 1 || parse_threads > 1) && source.text().size() >= 2 * MIN_LEX_CHUNK) {
+            parser.emplace(tokenize(source.text(), lex_threads), parse_threads);
+        } else {
+            parser.emplace(Lexer(source.text()));
+        }
+        ast_root = parser->parse();
+        SourceManager::global().setLineTable(parser->takeLineTable());
+
+        // A cache hit skips the lexer and parser, and with them anything they would print.
+        // A source that got diagnostics is parsed again next time so they show up again.
+        bool clean = parser->diagnosticCount() == 0;
+        if (ast_root && use_ast_cache && clean && !writeASTCache(cache_path, *ast_root, source_hash) && verbose) {
+            std::cerr << "Warning: Could not write AST cache '" << cache_path << "'\n";
+        }
+        if (parser->errorCount() > 0) {
+            std::cerr << "Compilation failed with lexer errors. Exiting.\n";
+            return 1;
+        }
+    }
 
     if (!ast_root) {
         std::cerr << "AST generation failed during parsing. Exiting.\n";
@@ -76,10 +197,24 @@ int main(int argc, char* argv[]) {
     if (verbose) ast_root->dump();
 
     // Perform semantic analysis
-    SemanticAnalyzer semanticAnalyzer(ast_root, parser.getSymbolTable());
+    SymbolTable symbol_table;
+    symbol_table.setDebugMode(debug_mode);
+    SemanticAnalyzer semanticAnalyzer(ast_root, symbol_table);
     semanticAnalyzer.setIsEntryPoint(is_entry);
     semanticAnalyzer.analyze();
 
+    // Exported after analysis so the records carry resolved types and symbols.
+    // Defaults to the assembly path with an .ast.json/.ast.bin extension.
+    if (ast_export) {
+        if (ast_export_path.empty()) {
+            std::string base = output_asm_filename;
+            if (base.size() > 4 && base.compare(base.size() - 4, 4, ".asm") == 0) base.resize(base.size() - 4);
+            ast_export_path = base + (ast_export->format == ASTExportFormat::JSON ? ".ast.json" : ".ast.bin");
+        }
+        exportAST(*ast_root, ast_export_path, *ast_export);
+        if (verbose) std::cout << "Exported AST to '" << ast_export_path << "'\n";
+    }
+
     // Generate code
     CodeGenerator codeGenerator(ast_root, semanticAnalyzer.getSymbolTable());
     codeGenerator.generate(output_asm_filename, is_entry);
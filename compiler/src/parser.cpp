@@ -4,26 +4,89 @@
 #include <utility>
 #include <map>
 #include <cctype>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "parser.hpp"
 #include "lexer.hpp"
 #include "ast.hpp"
 
-Parser::Parser(std::vector<Token> tokens) : tokens(std::move(tokens)), current_token_index(0) {}
+namespace {
+
+// Binding power of each binary operator, higher binds tighter. 0 means the token
+// does not continue an expression. Assignment is right associative and stays in parseExpression.
+enum Precedence : uint8_t {
+    PREC_NONE = 0,
+    PREC_COMPARISON,     // == != < <= > >=
+    PREC_ADDITIVE,       // + -
+    PREC_MULTIPLICATIVE, // * /
+};
+
+constexpr std::array<uint8_t, Token::UNKNOWN + 1> buildPrecedences() {
+    std::array<uint8_t, Token::UNKNOWN + 1> table = {};
+    for (Token::Type type : {Token::EQUAL_EQUAL, Token::BANG_EQUAL, Token::LESS,
+                             Token::LESS_EQUAL, Token::GREATER, Token::GREATER_EQUAL}) {
+        table[type] = PREC_COMPARISON;
+    }
+    table[Token::PLUS] = table[Token::MINUS] = PREC_ADDITIVE;
+    table[Token::STAR] = table[Token::SLASH] = PREC_MULTIPLICATIVE;
+    return table;
+}
+
+constexpr std::array<uint8_t, Token::UNKNOWN + 1> BINARY_PRECEDENCE = buildPrecedences();
+
+inline uint8_t binaryPrecedence(Token::Type type) { return BINARY_PRECEDENCE[type]; }
+
+inline bool isPrefixOperator(Token::Type type) {
+    return type == Token::STAR || type == Token::ADDRESSOF || type == Token::BANG;
+}
+
+} // namespace
+
+Parser::Parser(Lexer lexer) : lexer(std::move(lexer)) {}
+
+Parser::Parser(TokenBuffer tokens, unsigned threads)
+    : lexer(tokens.source()), owned_tokens(std::move(tokens)), buffered(&*owned_tokens), parse_threads(threads) {}
 
-const Token& Parser::peek(size_t offset) const {
-    size_t index = current_token_index + offset;
-    if (index >= tokens.size()) {
-        return tokens.back();
+Parser::Parser(const TokenBuffer& tokens, ASTArena& worker_arena)
+    : lexer(tokens.source()), buffered(&tokens), arena(&worker_arena) {}
+
+void Parser::seek(size_t index) {
+    buffered_index = index;
+    lookahead_head = 0;
+    lookahead_count = 0;
+    reached_end = false;
+}
+
+RawToken Parser::pullToken() {
+    if (!buffered) return lexer.next();
+    RawToken raw = buffered->raw(buffered_index);
+    if (buffered_index + 1 < buffered->size()) buffered_index++; // END_OF_FILE repeats like the lexer's
+    return raw;
+}
+
+Token Parser::peek(size_t offset) {
+    if (offset >= LOOKAHEAD) {
+        throw std::logic_error("Parser Error: Lookahead of " + std::to_string(offset) + " tokens is beyond the token ring.");
     }
-    return tokens[current_token_index + offset];
+    while (lookahead_count <= offset) {
+        lookahead[(lookahead_head + lookahead_count) & (LOOKAHEAD - 1)] = pullToken();
+        lookahead_count++;
+    }
+    return view(lookahead[(lookahead_head + offset) & (LOOKAHEAD - 1)]);
 }
 
-const Token& Parser::consume() {
-    if (current_token_index >= tokens.size()) {
+Token Parser::consume() {
+    if (reached_end) {
         throw std::runtime_error("Parser Error: Cannot consume token after end of file.");
     }
-    return tokens[current_token_index++];
+    Token token = peek();
+    if (token.type == Token::END_OF_FILE) reached_end = true;
+    lookahead_head = (lookahead_head + 1) & (LOOKAHEAD - 1);
+    lookahead_count--;
+    return token;
 }
 
 void Parser::expect(Token::Type expected_type, const std::string& error_msg) {
@@ -31,9 +94,8 @@ void Parser::expect(Token::Type expected_type, const std::string& error_msg) {
     if (current_token.type != expected_type) {
         throw std::runtime_error(error_msg +
             " (Got " + current_token.typeToString() +
-            " '" + current_token.value +
-            "' at line " + std::to_string(current_token.line) +
-            ", column " + std::to_string(current_token.column) + ")");
+            " '" + current_token.text() +
+            "' at " + current_token.where() + ")");
     } else {
         consume();
     }
@@ -47,7 +109,42 @@ bool Parser::match(Token::Type type) {
     return false;
 }
 
-std::unique_ptr<ConstantDeclarationNode> Parser::parseConstantDeclaration() {
+bool Parser::atWord(std::string_view word, size_t offset) {
+    Token token = peek(offset);
+    return token.type == Token::IDENTIFIER && token.value == word;
+}
+
+bool Parser::matchWord(std::string_view word) {
+    if (atWord(word)) {
+        consume();
+        return true;
+    }
+    return false;
+}
+
+// `align ( N )` followed by the type of a declaration; anything else starting with
+// `align` is an ordinary name, e.g. a call `align(4);` or `int align = 4;`
+bool Parser::atAlignmentPrefix() {
+    if (!atWord("align") || peek(1).type != Token::LPAREN || peek(2).type != Token::INTEGER_LITERAL ||
+        peek(3).type != Token::RPAREN) {
+        return false;
+    }
+    switch (peek(4).type) {
+        case Token::KEYWORD_INT:
+        case Token::KEYWORD_STRING:
+        case Token::KEYWORD_BOOL:
+        case Token::KEYWORD_CHAR:
+        case Token::KEYWORD_FLOAT:
+        case Token::KEYWORD_DOUBLE:
+        case Token::KEYWORD_AUTO:
+        case Token::IDENTIFIER:
+            return true;
+        default:
+            return false;
+    }
+}
+
+NodePtr<ConstantDeclarationNode> Parser::parseConstantDeclaration() {
     const Token& const_token = peek();
     expect(Token::KEYWORD_CONST, "Expected 'const' keyword.");
 
@@ -60,67 +157,63 @@ std::unique_ptr<ConstantDeclarationNode> Parser::parseConstantDeclaration() {
 
     auto initial_value = parseExpression();
 
-    return std::make_unique<ConstantDeclarationNode>(id_token.value, std::move(type), std::move(initial_value), const_token.line, const_token.column);
+    return newNode<ConstantDeclarationNode>(id_token.ident, std::move(type), std::move(initial_value), const_token.offset);
 }
 
-std::unique_ptr<IntegerLiteralExpressionNode> Parser::parseIntegerLiteralExpression() {
+NodePtr<IntegerLiteralExpressionNode> Parser::parseIntegerLiteralExpression() {
     const Token& int_token = peek();
     expect(Token::INTEGER_LITERAL, "Expected an integer literal.");
-    int value = std::stoi(int_token.value);
-    return std::make_unique<IntegerLiteralExpressionNode>(value, int_token.line, int_token.column);
+    int value = int_token.intValue();
+    return newNode<IntegerLiteralExpressionNode>(value, int_token.offset);
 }
 
-std::unique_ptr<StringLiteralExpressionNode> Parser::parseStringLiteralExpression() {
+NodePtr<StringLiteralExpressionNode> Parser::parseStringLiteralExpression() {
     const Token& str_token = peek();
     expect(Token::STRING_LITERAL, "Expected a string literal.");
-    return std::make_unique<StringLiteralExpressionNode>(str_token.value, str_token.line, str_token.column);
+    return newNode<StringLiteralExpressionNode>(str_token.text(), str_token.offset);
 }
 
-std::unique_ptr<BooleanLiteralExpressionNode> Parser::parseBooleanLiteralExpression() {
+NodePtr<BooleanLiteralExpressionNode> Parser::parseBooleanLiteralExpression() {
     const Token& bool_token = peek();
     if (bool_token.type == Token::TRUE) {
         consume();
-        return std::make_unique<BooleanLiteralExpressionNode>(true, bool_token.line, bool_token.column);
+        return newNode<BooleanLiteralExpressionNode>(true, bool_token.offset);
     } else if (bool_token.type == Token::FALSE) {
         consume();
-        return std::make_unique<BooleanLiteralExpressionNode>(false, bool_token.line, bool_token.column);
+        return newNode<BooleanLiteralExpressionNode>(false, bool_token.offset);
     }
     throw std::runtime_error("Expected 'true' or 'false' literal.");
 }
 
-std::unique_ptr<CharacterLiteralExpressionNode> Parser::parseCharacterLiteralExpression() {
+NodePtr<CharacterLiteralExpressionNode> Parser::parseCharacterLiteralExpression() {
     const Token& char_token = peek();
     expect(Token::CHARACTER_LITERAL, "Expected a character literal.");
-    return std::make_unique<CharacterLiteralExpressionNode>(char_token.value[0], char_token.line, char_token.column);
+    return newNode<CharacterLiteralExpressionNode>(char_token.value.empty() ? '\0' : char_token.value[0], char_token.offset);
 }
 
-std::unique_ptr<FloatLiteralExpressionNode> Parser::parseFloatLiteralExpression() {
+NodePtr<FloatLiteralExpressionNode> Parser::parseFloatLiteralExpression() {
     const Token& token = consume();
-    std::string valStr = token.value;
-    if (valStr.back() == 'f') valStr.pop_back();
-    return std::make_unique<FloatLiteralExpressionNode>(std::stof(valStr), token.line, token.column);
+    return newNode<FloatLiteralExpressionNode>(token.number.float_value, token.offset);
 }
 
-std::unique_ptr<DoubleLiteralExpressionNode> Parser::parseDoubleLiteralExpression() {
+NodePtr<DoubleLiteralExpressionNode> Parser::parseDoubleLiteralExpression() {
     const Token& token = consume();
-    std::string valStr = token.value;
-    if (valStr.back() == 'd') valStr.pop_back();
-    return std::make_unique<DoubleLiteralExpressionNode>(std::stod(valStr), token.line, token.column);
+    return newNode<DoubleLiteralExpressionNode>(token.number.double_value, token.offset);
 }
 
-std::unique_ptr<ReturnStatementNode> Parser::parseReturnStatement() {
+NodePtr<ReturnStatementNode> Parser::parseReturnStatement() {
     const Token& return_token = peek();
     expect(Token::KEYWORD_RETURN, "Expected 'return' keyword.");
     auto expr_node = parseExpression();
     expect(Token::SEMICOLON, "Expected ';' after return expression.");
-    return std::make_unique<ReturnStatementNode>(std::move(expr_node), return_token.line, return_token.column);
+    return newNode<ReturnStatementNode>(std::move(expr_node), return_token.offset);
 }
 
-std::unique_ptr<PrintStatementNode> Parser::parsePrintStatement() {
+NodePtr<PrintStatementNode> Parser::parsePrintStatement() {
     const Token& print_token = peek();
     expect(Token::KEYWORD_PRINT, "Expected 'print' keyword.");
 
-    std::vector<std::unique_ptr<ASTNode>> expressions;
+    std::vector<NodePtr<ASTNode>> expressions;
     expressions.push_back(parseExpression());
 
     while (peek().type == Token::COMMA) {
@@ -129,10 +222,10 @@ std::unique_ptr<PrintStatementNode> Parser::parsePrintStatement() {
     }
 
     expect(Token::SEMICOLON, "Expected ';' after print statement.");
-    return std::make_unique<PrintStatementNode>(std::move(expressions), print_token.line, print_token.column);
+    return newNode<PrintStatementNode>(std::move(expressions), print_token.offset);
 }
 
-std::unique_ptr<IfStatementNode> Parser::parseIfStatement() {
+NodePtr<IfStatementNode> Parser::parseIfStatement() {
     const Token& if_token = peek();
     expect(Token::KEYWORD_IF, "Expected 'if' keyword.");
     expect(Token::LPAREN, "Expected '(' after 'if'.");
@@ -142,7 +235,7 @@ std::unique_ptr<IfStatementNode> Parser::parseIfStatement() {
     expect(Token::RPAREN, "Expected ')' after if condition.");
     expect(Token::LBRACE, "Expected '{' to begin 'if' block.");
 
-    std::vector<std::unique_ptr<ASTNode>> true_block;
+    std::vector<NodePtr<ASTNode>> true_block;
 
     while (peek().type != Token::RBRACE && peek().type != Token::END_OF_FILE) {
         true_block.push_back(parseStatement());
@@ -150,7 +243,7 @@ std::unique_ptr<IfStatementNode> Parser::parseIfStatement() {
 
     expect(Token::RBRACE, "Expected '}' to close 'if' block.");
 
-    std::vector<std::unique_ptr<ASTNode>> false_block;
+    std::vector<NodePtr<ASTNode>> false_block;
 
     if (peek().type == Token::KEYWORD_ELSE) {
         consume();
@@ -161,15 +254,15 @@ std::unique_ptr<IfStatementNode> Parser::parseIfStatement() {
         expect(Token::RBRACE, "Expected '}' to close 'else' block.");
     }
 
-    return std::make_unique<IfStatementNode>(
+    return newNode<IfStatementNode>(
         std::move(condition),
         std::move(true_block),
         std::move(false_block),
-        if_token.line, if_token.column
+        if_token.offset
     );
 }
 
-std::unique_ptr<SwitchStatementNode> Parser::parseSwitchStatement() {
+NodePtr<SwitchStatementNode> Parser::parseSwitchStatement() {
     const Token& switch_token = peek();
     expect(Token::KEYWORD_SWITCH, "Expected 'switch' keyword.");
     expect(Token::LPAREN, "Expected '(' after 'switch'.");
@@ -179,7 +272,7 @@ std::unique_ptr<SwitchStatementNode> Parser::parseSwitchStatement() {
     expect(Token::RPAREN, "Expected ')' after 'switch' condition.");
     expect(Token::LBRACE, "Expected '{' to begin 'switch' block.");
 
-    auto switch_node = std::make_unique<SwitchStatementNode>();
+    auto switch_node = newNode<SwitchStatementNode>(switch_token.offset);
     switch_node->condition = std::move(condition);
 
     while(peek().type != Token::RBRACE) {
@@ -209,7 +302,7 @@ std::unique_ptr<SwitchStatementNode> Parser::parseSwitchStatement() {
     return switch_node;
 }
 
-std::unique_ptr<WhileStatementNode> Parser::parseWhileStatement() {
+NodePtr<WhileStatementNode> Parser::parseWhileStatement() {
     const Token& while_token = peek();
     expect(Token::KEYWORD_WHILE, "Expected 'while' keyword.");
     expect(Token::LPAREN, "Expected '(' after 'while'.");
@@ -219,26 +312,26 @@ std::unique_ptr<WhileStatementNode> Parser::parseWhileStatement() {
     expect(Token::RPAREN, "Expected ')' after while condition.");
     expect(Token::LBRACE, "Expected '{' to begin 'while' block.");
 
-    std::vector<std::unique_ptr<ASTNode>> body;
+    std::vector<NodePtr<ASTNode>> body;
     while (peek().type != Token::RBRACE && peek().type != Token::END_OF_FILE) {
         body.push_back(parseStatement());
     }
 
     expect(Token::RBRACE, "Expected '}' to close 'while' block.");
 
-    return std::make_unique<WhileStatementNode>(
+    return newNode<WhileStatementNode>(
         std::move(condition),
         std::move(body),
-        while_token.line, while_token.column
+        while_token.offset
     );
 }
 
-    std::unique_ptr<ForStatementNode> Parser::parseForStatement() {
+    NodePtr<ForStatementNode> Parser::parseForStatement() {
     const Token& for_token = peek();
     expect(Token::KEYWORD_FOR, "Expected 'for' keyword.");
     expect(Token::LPAREN, "Expected '(' after 'for'.");
 
-    std::unique_ptr<ASTNode> initializer = nullptr;
+    NodePtr<ASTNode> initializer = nullptr;
     // Parse initializer (optional)
     if (peek().type != Token::SEMICOLON) {
         // If it starts with a type keyword, it's a declaration
@@ -252,14 +345,14 @@ std::unique_ptr<WhileStatementNode> Parser::parseWhileStatement() {
     }
     expect(Token::SEMICOLON, "Expected ';' after for loop initializer.");
 
-    std::unique_ptr<ASTNode> condition = nullptr;
+    NodePtr<ASTNode> condition = nullptr;
     // Parse condition (optional)
     if (peek().type != Token::SEMICOLON) {
         condition = parseExpression();
     }
     expect(Token::SEMICOLON, "Expected ';' after for loop condition.");
 
-    std::unique_ptr<ASTNode> increment = nullptr;
+    NodePtr<ASTNode> increment = nullptr;
     // Parse increment (optional)
     if (peek().type != Token::RPAREN) {
         increment = parseExpression();
@@ -268,25 +361,25 @@ std::unique_ptr<WhileStatementNode> Parser::parseWhileStatement() {
 
     expect(Token::LBRACE, "Expected '{' to begin 'for' block.");
 
-    std::vector<std::unique_ptr<ASTNode>> body;
+    std::vector<NodePtr<ASTNode>> body;
     while (peek().type != Token::RBRACE && peek().type != Token::END_OF_FILE) {
         body.push_back(parseStatement());
     }
 
     expect(Token::RBRACE, "Expected '}' to close 'for' block.");
 
-    return std::make_unique<ForStatementNode>(
+    return newNode<ForStatementNode>(
         std::move(initializer),
         std::move(condition),
         std::move(increment),
         std::move(body),
-        for_token.line, for_token.column
+        for_token.offset
     );
 }
 
-std::unique_ptr<TypeNode> Parser::parseType() {
+const TypeNode* Parser::parseType() {
     const Token& type_token = peek();
-    std::unique_ptr<TypeNode> type;
+    const TypeNode* type;
 
     if (type_token.type == Token::KEYWORD_INT ||
         type_token.type == Token::KEYWORD_STRING ||
@@ -296,37 +389,38 @@ std::unique_ptr<TypeNode> Parser::parseType() {
         type_token.type == Token::KEYWORD_CHAR ||
 	    type_token.type == Token::KEYWORD_VOID) {
         consume();
-        type = std::make_unique<PrimitiveTypeNode>(type_token.type);
+        type = primitiveType(type_token.type);
     } else if (type_token.type == Token::KEYWORD_AUTO) {
         consume();
-        type = std::make_unique<AutoTypeNode>();
+        type = autoType();
     } else if (type_token.type == Token::IDENTIFIER) {
         consume();
-        type = std::make_unique<StructTypeNode>(type_token.value);
+        type = structType(type_token.text());
     // } else if (type_token.type == Token::DOUBLE_COLON) {
     //     consume();
-    //     type = std::make_unique<NamespaceDefinition>(type_token.value);
+    //     type = newNode<NamespaceDefinition>(type_token.value);
     } else {
         throw std::runtime_error("Expected 'int', 'string', 'bool', 'char', or a defined struct name for type.");
     }
 
     while (peek().type == Token::STAR) {
         consume();
-        type = std::make_unique<PointerTypeNode>(std::move(type));
+        type = pointerType(type);
     }
 
     return type;
 }
 
-std::unique_ptr<VariableDeclarationNode> Parser::parseVariableDeclaration() {
+NodePtr<VariableDeclarationNode> Parser::parseVariableDeclaration() {
+    SourceLoc type_loc = peek().offset;
     auto type = parseType();
     if (peek().type == Token::COLON) {
         consume();
         std::vector<Declaration> declarations;
 	do {
-    	std::string name = peek().value;
+    	Ident name = peek().ident;
 	    expect(Token::IDENTIFIER, "Expected variable name.");
-    	std::unique_ptr<ASTNode> init = nullptr;
+    	NodePtr<ASTNode> init = nullptr;
     	if (match(Token::EQ)) {
             init = parseExpression();
     	}
@@ -334,7 +428,7 @@ std::unique_ptr<VariableDeclarationNode> Parser::parseVariableDeclaration() {
 	    if (peek().type == Token::SEMICOLON) break;
 	} while (match(Token::COMMA));
 	    // expect(Token::SEMICOLON, "Expected semicolon ';'.");
-	    return std::make_unique<VariableDeclarationNode>(std::move(type), std::move(declarations));
+	    return newNode<VariableDeclarationNode>(std::move(type), std::move(declarations), type_loc);
     }
 
     const Token& id_token = peek();
@@ -344,29 +438,29 @@ std::unique_ptr<VariableDeclarationNode> Parser::parseVariableDeclaration() {
         consume(); // Consume '['
         const Token& size_token = peek();
         expect(Token::INTEGER_LITERAL, "Expected integer literal for array size.");
-        int size = std::stoi(size_token.value);
+        int size = size_token.intValue();
         expect(Token::RBRACKET, "Expected ']' after array size.");
-        type = std::make_unique<ArrayTypeNode>(std::move(type), size);
+        type = arrayType(type, size);
     }
 
-    std::unique_ptr<ASTNode> initial_value = nullptr;
+    NodePtr<ASTNode> initial_value = nullptr;
     if (peek().type == Token::EQ) {
         consume(); // Consume '='
         initial_value = parseExpression();
     }
 
-    // return std::make_unique<VariableDeclarationNode>(id_token.value, std::move(type), std::move(initial_value), id_token.line, id_token.column);
+    // return newNode<VariableDeclarationNode>(id_token.value, std::move(type), std::move(initial_value), id_token.line(), id_token.column());
     std::vector<Declaration> declarations;
-    declarations.push_back({id_token.value, std::move(initial_value)}); 
-    return std::make_unique<VariableDeclarationNode>(std::move(type), std::move(declarations));
+    declarations.push_back({id_token.ident, std::move(initial_value)}); 
+    return newNode<VariableDeclarationNode>(std::move(type), std::move(declarations), id_token.offset);
 }
 
-std::unique_ptr<FunctionCallNode> Parser::parseFunctionCall() {
+NodePtr<FunctionCallNode> Parser::parseFunctionCall() {
     const Token& id_token = consume(); // Consume the function name identifier
 
     expect(Token::LPAREN, "Expected '(' after function name for a function call.");
 
-    std::vector<std::unique_ptr<ASTNode>> arguments;
+    std::vector<NodePtr<ASTNode>> arguments;
     if (peek().type != Token::RPAREN) {
         arguments.push_back(parseExpression());
         while (peek().type == Token::COMMA) {
@@ -377,136 +471,127 @@ std::unique_ptr<FunctionCallNode> Parser::parseFunctionCall() {
 
     expect(Token::RPAREN, "Expected ')' after function call arguments.");
 
-    return std::make_unique<FunctionCallNode>(id_token.value, std::move(arguments), id_token.line, id_token.column);
+    return newNode<FunctionCallNode>(id_token.ident, std::move(arguments), id_token.offset);
 }
 
-std::unique_ptr<ASTNode> Parser::parseFactor() {
-    std::unique_ptr<ASTNode> node;
+NodePtr<ASTNode> Parser::parsePrimaryExpression() {
     const Token& current_token = peek();
 
-    if (current_token.type == Token::INTEGER_LITERAL) {
-        node = parseIntegerLiteralExpression();
-    } else if (current_token.type == Token::FLOAT_LITERAL) {
-        node = parseFloatLiteralExpression();
-    } else if (current_token.type == Token::DOUBLE_LITERAL) {
-        node = parseDoubleLiteralExpression();
-    } else if (current_token.type == Token::IDENTIFIER) {
-        if (peek(1).type == Token::DOUBLE_COLON) {
-            const auto& ns_token = consume();
-            consume();
-            auto member = parseFactor();
-            node = std::make_unique<ScopeResolutionNode>(ns_token.value, std::move(member), ns_token.line, ns_token.column);
-        } else if (peek(1).type == Token::LPAREN) {
-            node = parseFunctionCall();
-        } else if (peek(1).type == Token::LBRACKET) {
-            const auto& id_token = consume();
-            auto var_ref = std::make_unique<VariableReferenceNode>(id_token.value, id_token.line, id_token.column);
-            consume(); // consume '['
-            auto index_expr = parseExpression();
-            expect(Token::RBRACKET, "Expected ']' after array index.");
-            node = std::make_unique<ArrayAccessNode>(std::move(var_ref), std::move(index_expr));
-        } else {
+    switch (current_token.type) {
+        case Token::INTEGER_LITERAL: return parseIntegerLiteralExpression();
+        case Token::FLOAT_LITERAL: return parseFloatLiteralExpression();
+        case Token::DOUBLE_LITERAL: return parseDoubleLiteralExpression();
+        case Token::STRING_LITERAL: return parseStringLiteralExpression();
+        case Token::TRUE:
+        case Token::FALSE: return parseBooleanLiteralExpression();
+        case Token::CHARACTER_LITERAL: return parseCharacterLiteralExpression();
+        case Token::IDENTIFIER: {
+            Token::Type next = peek(1).type;
+            if (next == Token::DOUBLE_COLON) {
+                const auto& ns_token = consume();
+                consume();
+                auto member = parsePostfixExpression();
+                return newNode<ScopeResolutionNode>(ns_token.ident, std::move(member), ns_token.offset);
+            }
+            if (next == Token::LPAREN) return parseFunctionCall(); // The call node carries the callee's name
             const auto& id_token = consume();
-            node = std::make_unique<VariableReferenceNode>(id_token.value, id_token.line, id_token.column);
+            return newNode<VariableReferenceNode>(id_token.ident, id_token.offset);
         }
-    } else if (current_token.type == Token::LPAREN) {
-        consume();
-        node = parseExpression();
-        expect(Token::RPAREN, "Expected ')' after expression in parentheses.");
-    } else if (current_token.type == Token::STRING_LITERAL) {
-        node = parseStringLiteralExpression();
-    } else if (current_token.type == Token::TRUE || current_token.type == Token::FALSE) {
-        node = parseBooleanLiteralExpression();
-    } else if (current_token.type == Token::CHARACTER_LITERAL) {
-        node = parseCharacterLiteralExpression();
-    } else {
-        throw std::runtime_error("Parser Error: Expected an integer literal, identifier, or '(' for an expression factor. Got '" +
-                                 current_token.value + "' at line " + std::to_string(current_token.line) +
-                                 ", column " + std::to_string(current_token.column) + ".");
-    }
-
-    // Handle member access (e.g., struct_instance.member)
-    while (peek().type == Token::DOT) {
-        consume(); // Consume '.'
-        const Token& member_name_token = consume();
-        if (member_name_token.type != Token::IDENTIFIER) {
-            throw std::runtime_error("Expected identifier after '.' for member access.");
+        case Token::LPAREN: {
+            consume();
+            auto node = parseExpression();
+            expect(Token::RPAREN, "Expected ')' after expression in parentheses.");
+            return node;
         }
-        node = std::make_unique<MemberAccessNode>(std::move(node), member_name_token.value, member_name_token.line, member_name_token.column);
-    }
-
-    return node;
-}
-
-std::unique_ptr<ASTNode> Parser::parseUnaryExpression() {
-    if (peek().type == Token::STAR || peek().type == Token::ADDRESSOF) {
-        const Token& op_token = consume();
-        auto operand = parseUnaryExpression();
-        return std::make_unique<UnaryOpExpressionNode>(op_token.type, std::move(operand), op_token.line, op_token.column);
-    }
-    else if (peek().type == Token::BANG) {
-	const Token& op_token = consume();
-	auto operand = parseUnaryExpression();
-        return std::make_unique<UnaryOpExpressionNode>(op_token.type, std::move(operand), op_token.line, op_token.column);
+        default:
+            throw std::runtime_error("Parser Error: Expected an integer literal, identifier, or '(' for an expression factor. Got '" +
+                                     current_token.text() + "' at " + current_token.where() + ".");
     }
-    return parseFactor();
 }
 
-std::unique_ptr<ASTNode> Parser::parseTerm() {
-    auto left_expr = parseUnaryExpression();
+NodePtr<ASTNode> Parser::parsePostfixExpression() {
+    auto node = parsePrimaryExpression();
 
-    while (peek().type == Token::STAR || peek().type == Token::SLASH) {
-        const Token& op_token = consume();
-        auto right_expr = parseUnaryExpression();
-        left_expr = std::make_unique<BinaryOperationExpressionNode>(
-            std::move(left_expr), op_token.type, std::move(right_expr),
-            op_token.line, op_token.column
-        );
+    for (;;) {
+        if (peek().type == Token::DOT) { // Member access (e.g., struct_instance.member)
+            consume(); // Consume '.'
+            const Token& member_name_token = consume();
+            if (member_name_token.type != Token::IDENTIFIER) {
+                throw std::runtime_error("Expected identifier after '.' for member access.");
+            }
+            node = newNode<MemberAccessNode>(std::move(node), member_name_token.ident, member_name_token.offset);
+        } else if (peek().type == Token::LBRACKET && node->node_type == ASTNode::NodeType::VARIABLE_REFERENCE) {
+            const Token& bracket_token = consume(); // consume '['
+            auto index_expr = parseExpression();
+            expect(Token::RBRACKET, "Expected ']' after array index.");
+            node = newNode<ArrayAccessNode>(std::move(node), std::move(index_expr), bracket_token.offset);
+        } else {
+            return node;
+        }
     }
-    return left_expr;
 }
 
-std::unique_ptr<ASTNode> Parser::parseAdditiveExpression() {
-    auto left = parseTerm();
-
-    while (peek().type == Token::PLUS || peek().type == Token::MINUS) {
-        const Token& op_token = consume();
-        auto right = parseTerm();
-        left = std::make_unique<BinaryOperationExpressionNode>(
-            std::move(left), op_token.type, std::move(right),
-            op_token.line, op_token.column
-        );
+NodePtr<ASTNode> Parser::parseUnaryExpression() {
+    // Prefix operators are stacked and applied innermost first, so "!!*p" needs no recursion
+    size_t base = operator_stack.size();
+    while (isPrefixOperator(peek().type)) {
+        operator_stack.push_back(consume());
     }
 
-    return left;
+    auto node = parsePostfixExpression();
+    while (operator_stack.size() > base) {
+        Token op_token = operator_stack.back();
+        operator_stack.pop_back();
+        node = newNode<UnaryOpExpressionNode>(op_token.type, std::move(node), op_token.offset);
+    }
+    return node;
 }
 
-std::unique_ptr<ASTNode> Parser::parseComparisonExpression() {
-    auto left = parseAdditiveExpression();
-
-    while (peek().type == Token::EQUAL_EQUAL || peek().type == Token::BANG_EQUAL ||
-           peek().type == Token::LESS || peek().type == Token::LESS_EQUAL ||
-           peek().type == Token::GREATER || peek().type == Token::GREATER_EQUAL) {
-        const Token& op_token = consume();
-        auto right = parseAdditiveExpression();
-        left = std::make_unique<BinaryOperationExpressionNode>(
+// Precedence climbing over explicit operand/operator stacks. Every binary operator is
+// left associative, so an operator on the stack is reduced as soon as one of equal or
+// lower precedence arrives. A chain of any length runs in this one loop, and the stacks
+// are parser members, so after the first few expressions nothing is allocated here either.
+NodePtr<ASTNode> Parser::parseBinaryExpression() {
+    size_t operator_base = operator_stack.size();
+
+    auto reduce = [this]() {
+        Token op_token = operator_stack.back();
+        operator_stack.pop_back();
+        auto right = std::move(operand_stack.back());
+        operand_stack.pop_back();
+        auto& left = operand_stack.back();
+        left = newNode<BinaryOperationExpressionNode>(
             std::move(left), op_token.type, std::move(right),
-            op_token.line, op_token.column
+            op_token.offset
         );
+    };
+
+    operand_stack.push_back(parseUnaryExpression());
+    while (uint8_t precedence = binaryPrecedence(peek().type)) {
+        while (operator_stack.size() > operator_base && binaryPrecedence(operator_stack.back().type) >= precedence) {
+            reduce();
+        }
+        operator_stack.push_back(consume());
+        operand_stack.push_back(parseUnaryExpression());
+    }
+    while (operator_stack.size() > operator_base) {
+        reduce();
     }
 
-    return left;
+    auto result = std::move(operand_stack.back());
+    operand_stack.pop_back();
+    return result;
 }
 
-std::unique_ptr<ASTNode> Parser::parseExpression() {
-    auto left = parseComparisonExpression();
+NodePtr<ASTNode> Parser::parseExpression() {
+    auto left = parseBinaryExpression();
 
     if (peek().type == Token::EQ) {
-        consume(); // consume '='
+        const Token& eq_token = consume(); // consume '='
         auto right = parseExpression();
 
         if (dynamic_cast<VariableReferenceNode*>(left.get()) || dynamic_cast<MemberAccessNode*>(left.get()) || dynamic_cast<ArrayAccessNode*>(left.get())) {
-            return std::make_unique<VariableAssignmentNode>(std::move(left), std::move(right));
+            return newNode<VariableAssignmentNode>(std::move(left), std::move(right), eq_token.offset);
         } else {
             throw std::runtime_error("Invalid left-hand side in assignment expression.");
         }
@@ -515,14 +600,25 @@ std::unique_ptr<ASTNode> Parser::parseExpression() {
     return left;
 }
 
-std::unique_ptr<StructDefinitionNode> Parser::parseStructDefinition() {
-    consume();
-    std::string struct_name = consume().value;
+NodePtr<StructDefinitionNode> Parser::parseStructDefinition() {
+    const Token& struct_token = consume();
+    std::string struct_name = consume().text();
+    auto struct_node = newNode<StructDefinitionNode>(struct_name, struct_token.offset);
+
+    // Layout attributes, in any order. They're not keywords, only their spelling counts here.
+    while (peek().type != Token::LBRACE && peek().type != Token::END_OF_FILE) {
+        if (matchWord("packed")) {
+            struct_node->packed = true;
+        } else if (matchWord("reorder")) {
+            struct_node->reorder = true;
+        } else if (atWord("align") && peek(1).type == Token::LPAREN) {
+            struct_node->explicit_align = parseAlignment();
+        } else {
+            break;
+        }
+    }
     expect(Token::LBRACE, "Expected '{' after struct name.");
 
-    auto struct_node = std::make_unique<StructDefinitionNode>(struct_name);
-    int current_offset = 0;
-
     StructMember::Visibility current_visibility = StructMember::Visibility::PUBLIC; // Default to public
 
     while (peek().type != Token::RBRACE && peek().type != Token::END_OF_FILE) {
@@ -540,47 +636,39 @@ std::unique_ptr<StructDefinitionNode> Parser::parseStructDefinition() {
         }
 
         auto member_type = parseType();
-        std::string member_name = consume().value;
+        Ident member_name = consume().ident;
         expect(Token::SEMICOLON, "Expected ';' after struct member declaration.");
 
-        int member_size = 0;
-        if (auto primitive_type = dynamic_cast<PrimitiveTypeNode*>(member_type.get())) {
-            switch (primitive_type->primitive_type) {
-                case Token::KEYWORD_INT: member_size = 4;
-                    break;
-                case Token::KEYWORD_CHAR: member_size = 1;
-                    break;
-                case Token::KEYWORD_BOOL: member_size = 1;
-                    break;
-                default: member_size = 0; // Should not happen
-            }
-        } else if (auto pointer_type = dynamic_cast<PointerTypeNode*>(member_type.get())) {
-            member_size = 8; // Size of a pointer
-        } else if (auto array_type = dynamic_cast<ArrayTypeNode*>(member_type.get())) {
-            // This is a simplification. A proper implementation would need to know the size of the base type.
-            member_size = 8; // Treat array as a pointer for now
-        } else if (auto struct_type = dynamic_cast<StructTypeNode*>(member_type.get())) {
-            // We can't know the size of another struct at parse time, so we'll have to calculate it in the semantic analyzer
-            member_size = 0; 
-        }
-
-        struct_node->members.push_back({std::move(member_type), member_name, current_offset, current_visibility});
-        current_offset += member_size;
+        // Offsets and the struct's size are left to the LayoutTable, it needs every member type defined
+        struct_node->members.push_back({std::move(member_type), member_name, 0, current_visibility});
     }
 
-    struct_node->size = current_offset;
     expect(Token::RBRACE, "Expected '}' after struct definition.");
     return struct_node;
 }
 
-std::unique_ptr<NamespaceDefinition> Parser::parseNamespaceDefinition() {
+int Parser::parseAlignment() {
+    if (!matchWord("align")) throw std::runtime_error("Parser Error: Expected 'align' at " + peek().where() + ".");
+    expect(Token::LPAREN, "Expected '(' after 'align'.");
+    const Token& value_token = peek();
+    expect(Token::INTEGER_LITERAL, "Expected integer literal for alignment.");
+    int value = value_token.intValue();
+    if (value <= 0 || (value & (value - 1)) != 0) {
+        throw std::runtime_error("Parser Error: Alignment must be a power of two, got " + std::to_string(value) +
+                                 " at " + value_token.where() + ".");
+    }
+    expect(Token::RPAREN, "Expected ')' after alignment.");
+    return value;
+}
+
+NodePtr<NamespaceDefinition> Parser::parseNamespaceDefinition() {
     const Token& start_token = peek();
     expect(Token::KEYWORD_NAMESPACE, "Expected 'namespace' keyword.");
 
     const Token& ns_name = peek();
     expect(Token::IDENTIFIER, "Expected namespace name.");
 
-    auto namespace_node = std::make_unique<NamespaceDefinition>(ns_name.value, start_token.line, start_token.column);
+    auto namespace_node = newNode<NamespaceDefinition>(ns_name.ident, start_token.offset);
 
     expect(Token::LBRACE, "Expected '{' after namespace name.");
 
@@ -593,7 +681,7 @@ std::unique_ptr<NamespaceDefinition> Parser::parseNamespaceDefinition() {
         auto member_node = parseStatement();
         if (!member_node) continue; // Safety check
 
-        std::string name_to_register = "";
+        Ident name_to_register = NO_IDENT;
 
         if (auto* v = dynamic_cast<VariableDeclarationNode*>(member_node.get())) {
             if (!v->declarations.empty()) name_to_register = v->declarations[0].name;
@@ -602,13 +690,14 @@ std::unique_ptr<NamespaceDefinition> Parser::parseNamespaceDefinition() {
         } else if (auto* f = dynamic_cast<FunctionDefinitionNode*>(member_node.get())) {
             name_to_register = f->name;
         } else if (auto* s = dynamic_cast<StructDefinitionNode*>(member_node.get())) {
-            name_to_register = s->name;
+            name_to_register = intern(s->name);
         }
 
-        if (!name_to_register.empty()) {
+        if (name_to_register != NO_IDENT) {
             namespace_node->members.push_back({name_to_register, std::move(member_node)});
         } else {
-            std::cerr << "Parser Warning: Skipping node " << (int)member_node->node_type << " in namespace at line " << start_token.line << std::endl;
+            warnings++;
+            if (!quiet) std::cerr << "Parser Warning: Skipping node " << (int)member_node->node_type << " in namespace at " << start_token.where() << std::endl;
         }
 
         if (peek().type == Token::SEMICOLON) consume();
@@ -618,7 +707,7 @@ std::unique_ptr<NamespaceDefinition> Parser::parseNamespaceDefinition() {
     return namespace_node;
 }
 
-std::unique_ptr<EnumStatementNode> Parser::parseEnumStatement() {
+NodePtr<EnumStatementNode> Parser::parseEnumStatement() {
     const Token& enum_start_token = peek();
     expect(Token::KEYWORD_ENUM, "Expected 'enum' keyword.");
 
@@ -632,13 +721,13 @@ std::unique_ptr<EnumStatementNode> Parser::parseEnumStatement() {
         const Token& member_name_token = peek();
         expect(Token::IDENTIFIER, "Expected enum member name.");
 
-        std::unique_ptr<ASTNode> value = nullptr;
+        NodePtr<ASTNode> value = nullptr;
         if (peek().type == Token::EQ) {
             consume(); // consume '='
             value = parseExpression();
         }
 
-        members.push_back(std::make_unique<EnumMemberNode>(member_name_token.value, std::move(value)));
+        members.push_back(std::make_unique<EnumMemberNode>(member_name_token.ident, std::move(value)));
 
         if (peek().type == Token::COMMA) {
             consume();
@@ -648,10 +737,10 @@ std::unique_ptr<EnumStatementNode> Parser::parseEnumStatement() {
     }
     expect(Token::RBRACE, "Expected '}' to close enum declaration.");
 
-    return std::make_unique<EnumStatementNode>(name_token_val.value, std::move(members), enum_start_token.line, enum_start_token.column);
+    return newNode<EnumStatementNode>(name_token_val.ident, std::move(members), enum_start_token.offset);
 }
 
-std::unique_ptr<AsmStatementNode> Parser::parseAsmStatement() {
+NodePtr<AsmStatementNode> Parser::parseAsmStatement() {
     const Token& asm_token = peek();
     expect(Token::KEYWORD_ASM, "Expected 'asm' keyword.");
 
@@ -672,7 +761,7 @@ std::unique_ptr<AsmStatementNode> Parser::parseAsmStatement() {
     std::vector<std::string> asm_lines;
     while (peek().type != closing_type && peek().type != Token::END_OF_FILE) {
         if (peek().type == Token::STRING_LITERAL) {
-            asm_lines.push_back(consume().value);
+            asm_lines.push_back(consume().text());
         } else {
             throw std::runtime_error("Parser Error: Only string literals are allowed inside asm blocks. "
                 "Example: asm { \"mov rax, 1\"; \"add rax, rbx\"; }");
@@ -681,10 +770,10 @@ std::unique_ptr<AsmStatementNode> Parser::parseAsmStatement() {
 
     expect(closing_type, "Expected closing delimeter for asm block.");
     if (is_paren_block) expect(Token::SEMICOLON, "Expected ';' after inline assembly statement");
-    return std::make_unique<AsmStatementNode>(std::move(asm_lines), asm_token.line, asm_token.column);
+    return newNode<AsmStatementNode>(std::move(asm_lines), asm_token.offset);
 }
 
-std::unique_ptr<ASTNode> Parser::parseStatement() {
+NodePtr<ASTNode> Parser::parseStatement() {
     switch (peek().type) {
         case Token::KEYWORD_CONST: {
             auto decl_node = parseConstantDeclaration();
@@ -709,7 +798,13 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
             }
         }
         case Token::IDENTIFIER: {
-            if (peek(1).type == Token::LPAREN) {
+            if (atAlignmentPrefix()) {
+                int align = parseAlignment();
+                auto decl_node = parseVariableDeclaration();
+                decl_node->align = align;
+                expect(Token::SEMICOLON, "Expected ';' after variable declaration.");
+                return decl_node;
+            } else if (peek(1).type == Token::LPAREN) {
                 auto func_call = parseFunctionCall();
                 expect(Token::SEMICOLON, "Expected ';' after function call statement.");
                 return func_call;
@@ -738,8 +833,7 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
             return parseNamespaceDefinition();
         default:
             throw std::runtime_error("Parser Error: Unexpected token in statement: '" +
-                                     peek().value + "' at line " + std::to_string(peek().line) +
-                                     ", column " + std::to_string(peek().column) + ".");
+                                     peek().text() + "' at " + peek().where() + ".");
     }
 }
 
@@ -756,7 +850,7 @@ std::vector<std::unique_ptr<ParameterNode>> Parser::parseParameters() {
             if (name_token.type != Token::IDENTIFIER) {
                 throw std::runtime_error("Expected identifier for parameter name.");
             }
-            param->name = name_token.value;
+            param->name = name_token.ident;
             parameters.push_back(std::move(param));
 
         } while (peek().type == Token::COMMA && (consume(), true));
@@ -766,7 +860,7 @@ std::vector<std::unique_ptr<ParameterNode>> Parser::parseParameters() {
     return parameters;
 }
 
-std::unique_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition() {
+NodePtr<FunctionDefinitionNode> Parser::parseFunctionDefinition(bool skip_body) {
     bool is_extern_func = false;
     if (peek().type == Token::KEYWORD_EXTERN) {
         consume(); // Consume 'extern'
@@ -778,9 +872,9 @@ std::unique_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition() {
     const Token& function_name_token = peek();
     expect(Token::IDENTIFIER, "Expected function name.");
 
-    auto func_def_node = std::make_unique<FunctionDefinitionNode>(
-        std::move(return_type), function_name_token.value,
-        function_name_token.line, function_name_token.column
+    auto func_def_node = newNode<FunctionDefinitionNode>(
+        std::move(return_type), function_name_token.ident,
+        function_name_token.offset
     );
     func_def_node->is_extern = is_extern_func; // Set the flag
 
@@ -791,38 +885,210 @@ std::unique_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition() {
     } else {
         expect(Token::LBRACE, "Expected '{' to begin function body.");
 
-        while (peek().type != Token::RBRACE && peek().type != Token::END_OF_FILE) {
-            func_def_node->body_statements.push_back(parseStatement());
+        // Top-level bodies are left to the workers during a parallel parse, skip to the '}'
+        if (deferred_bodies) {
+            size_t open = position() - 1;
+            auto it = std::lower_bound(top_level_braces.begin(), top_level_braces.end(), std::make_pair(open, size_t(0)));
+            if (it != top_level_braces.end() && it->first == open) {
+                deferred_bodies->push_back({func_def_node.get(), open + 1, it->second});
+                seek(it->second);
+                expect(Token::RBRACE, "Expected '}' to end function body.");
+                return func_def_node;
+            }
         }
 
-        expect(Token::RBRACE, "Expected '}' to end function body.");
+        if (skip_body) {
+            skipBody();
+            return func_def_node;
+        }
+
+        parseBody(position(), func_def_node->body_statements);
     }
 
     return func_def_node;
 }
 
-std::unique_ptr<ProgramNode> Parser::parse() {
+// Consumes tokens up to and including the '}' matching an already consumed '{'
+void Parser::skipBody() {
+    size_t depth = 1;
+    while (depth > 0) {
+        Token token = consume();
+        if (token.type == Token::LBRACE) {
+            depth++;
+        } else if (token.type == Token::RBRACE) {
+            depth--;
+        } else if (token.type == Token::END_OF_FILE) {
+            throw std::runtime_error("Expected '}' to end function body. (Got EOF at " + token.where() + ")");
+        }
+    }
+}
+
+void Parser::parseBody(size_t begin, std::vector<NodePtr<ASTNode>>& body) {
+    if (buffered) seek(begin); // Streaming parsers are always there already
+    while (peek().type != Token::RBRACE && peek().type != Token::END_OF_FILE) {
+        body.push_back(parseStatement());
+    }
+    expect(Token::RBRACE, "Expected '}' to end function body.");
+}
+
+// Records the matching '}' of every '{' at brace depth 0. Those are the only braces a
+// top-level function body can start with, so the serial pass can jump over a body
+// without parsing it. Unbalanced input just leaves some pairs out, the serial parse
+// reports it.
+void Parser::findTopLevelBraces() {
+    top_level_braces.clear();
+    size_t depth = 0, open = 0;
+    for (size_t i = 0; i < buffered->size(); ++i) {
+        Token::Type kind = buffered->kind(i);
+        if (kind == Token::LBRACE) {
+            if (depth++ == 0) open = i;
+        } else if (kind == Token::RBRACE && depth > 0) {
+            if (--depth == 0) top_level_braces.emplace_back(open, i);
+        }
+    }
+}
+
+// Parses the top level serially, deferring every top-level function body, then parses
+// the bodies on parse_threads workers. Each worker has its own Parser over the shared
+// tokens and its own arena, which the ProgramNode takes over. Bodies are written into
+// their FunctionDefinitionNode in place, so ProgramNode::functions stays in source order.
+// Returns nullptr if anything failed; the caller then parses serially from the start
+// so errors come out exactly as they would have without threads.
+std::unique_ptr<ProgramNode> Parser::parseParallel() {
+    findTopLevelBraces();
+
     auto program_node = std::make_unique<ProgramNode>();
-    while (peek().type != Token::END_OF_FILE) {
-        if (peek().type == Token::KEYWORD_EXTERN || (peek(1).type == Token::IDENTIFIER && peek(2).type == Token::LPAREN)) {
-            program_node->functions.push_back(parseFunctionDefinition());
-        } else if (peek().type == Token::KEYWORD_STRUCT) { // This is for struct definition
-            auto struct_def = parseStructDefinition();
-            if (struct_def) {
-                program_node->structs.push_back(std::move(struct_def));
-            }
-            if (peek().type == Token::SEMICOLON) {
-                consume(); // Consume optional semicolon after struct definition
+    arena = &program_node->arena;
+    std::vector<BodyJob> jobs;
+    deferred_bodies = &jobs;
+    try {
+        parseTopLevel(*program_node);
+    } catch (...) {
+        operand_stack.clear();
+        operator_stack.clear();
+        deferred_bodies = nullptr;
+        return nullptr;
+    }
+    deferred_bodies = nullptr;
+
+    unsigned workers = static_cast<unsigned>(std::min<size_t>(parse_threads, jobs.size()));
+    std::vector<std::unique_ptr<ASTArena>> worker_arenas;
+    for (unsigned i = 0; i < workers; ++i) worker_arenas.push_back(std::make_unique<ASTArena>());
+
+    std::atomic<size_t> next_job{0};
+    std::atomic<bool> failed{false};
+    auto work = [&](ASTArena& worker_arena) {
+        Parser worker(*buffered, worker_arena);
+        try {
+            for (size_t i = next_job++; i < jobs.size() && !failed; i = next_job++) {
+                worker.parseBody(jobs[i].begin, jobs[i].function->body_statements);
+                if (worker.position() != jobs[i].end + 1) failed = true; // Body ended at another '}'
             }
-        } else if (peek().type == Token::KEYWORD_ENUM) { // This is for enum definition
-            program_node->statements.push_back(parseEnumStatement());
-            if (peek().type == Token::SEMICOLON) {
-                consume(); // Consume optional semicolon after enum definition
+        } catch (...) {
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < workers; ++i) threads.emplace_back(work, std::ref(*worker_arenas[i]));
+    if (workers > 0) work(*worker_arenas[0]);
+    for (auto& thread : threads) thread.join();
+
+    program_node->worker_arenas = std::move(worker_arenas);
+    if (failed) return nullptr;
+    return program_node;
+}
+
+std::unique_ptr<ProgramNode> Parser::parse() {
+    if (buffered && parse_threads > 1 && buffered->size() >= MIN_PARALLEL_PARSE_TOKENS) {
+        if (auto program_node = parseParallel()) return program_node;
+        seek(0);
+    }
+
+    auto program_node = std::make_unique<ProgramNode>();
+    arena = &program_node->arena;
+    try {
+        parseTopLevel(*program_node);
+    } catch (...) {
+        // Half-built expressions on the stacks point into the arena, drop them before it goes
+        operand_stack.clear();
+        operator_stack.clear();
+        throw;
+    }
+    return program_node;
+}
+
+// Declarations-only pass of a streaming compilation: everything at the top level except
+// the bodies of top-level functions, which are skipped token by token. Namespaces are
+// parsed whole, functions inside them included.
+std::unique_ptr<ProgramNode> Parser::parseDeclarations() {
+    auto program_node = std::make_unique<ProgramNode>();
+    arena = &program_node->arena;
+    skip_top_level_bodies = true;
+    try {
+        parseTopLevel(*program_node);
+    } catch (...) {
+        operand_stack.clear();
+        operator_stack.clear();
+        throw;
+    }
+    skip_top_level_bodies = false;
+    return program_node;
+}
+
+// Bodies pass of a streaming compilation, over a fresh lexer on the same source. Returns
+// the next top-level function, body included, allocated in function_arena, or nullptr at
+// the end. Everything in between was handled by parseDeclarations(), so it is parsed
+// into a throwaway arena and dropped.
+NodePtr<FunctionDefinitionNode> Parser::parseNextFunction(ASTArena& function_arena) {
+    try {
+        while (peek().type != Token::END_OF_FILE) {
+            if (atFunctionDefinition()) {
+                arena = &function_arena;
+                return parseFunctionDefinition();
             }
+            ProgramNode skipped;
+            arena = &skipped.arena;
+            parseTopLevelDeclaration(skipped);
         }
-        else { // Everything else is a statement
-            program_node->statements.push_back(parseStatement());
+    } catch (...) {
+        operand_stack.clear();
+        operator_stack.clear();
+        throw;
+    }
+    return nullptr;
+}
+
+bool Parser::atFunctionDefinition() {
+    return peek().type == Token::KEYWORD_EXTERN || (peek(1).type == Token::IDENTIFIER && peek(2).type == Token::LPAREN);
+}
+
+void Parser::parseTopLevel(ProgramNode& program) {
+    while (peek().type != Token::END_OF_FILE) {
+        if (atFunctionDefinition()) {
+            program.functions.push_back(parseFunctionDefinition(skip_top_level_bodies));
+        } else {
+            parseTopLevelDeclaration(program);
         }
     }
-    return program_node;
+}
+
+void Parser::parseTopLevelDeclaration(ProgramNode& program) {
+    if (peek().type == Token::KEYWORD_STRUCT) { // This is for struct definition
+        auto struct_def = parseStructDefinition();
+        if (struct_def) {
+            program.structs.push_back(std::move(struct_def));
+        }
+        if (peek().type == Token::SEMICOLON) {
+            consume(); // Consume optional semicolon after struct definition
+        }
+    } else if (peek().type == Token::KEYWORD_ENUM) { // This is for enum definition
+        program.statements.push_back(parseEnumStatement());
+        if (peek().type == Token::SEMICOLON) {
+            consume(); // Consume optional semicolon after enum definition
+        }
+    }
+    else { // Everything else is a statement
+        program.statements.push_back(parseStatement());
+    }
 }
@@ -0,0 +1,137 @@
+#include "scan.hpp"
+#include "lexer.hpp"
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+inline bool isWhitespaceByte(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool isIdentifierByte(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Records a line start after every newline bit set in `newlines` (bit i = byte base + i).
+inline void recordNewlines(uint32_t newlines, size_t base, LineTable& lines) {
+    while (newlines) {
+        lines.addLineStart(static_cast<uint32_t>(base + __builtin_ctz(newlines) + 1));
+        newlines &= newlines - 1;
+    }
+}
+
+inline uint32_t lowBits(size_t count) {
+    return count >= 32 ? 0xFFFFFFFFu : ((1u << count) - 1);
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+// One vector's worth of bytes, comparisons produce one bit per byte.
+struct Block {
+#if defined(__AVX2__)
+    static constexpr size_t width = 32;
+    __m256i v;
+    explicit Block(const char* p) : v(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))) {}
+    static uint32_t bits(__m256i m) { return static_cast<uint32_t>(_mm256_movemask_epi8(m)); }
+    uint32_t eq(char c) const { return bits(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))); }
+    // Bytes in [lo, lo + n), done as a signed compare after biasing by -128
+    uint32_t inRange(char lo, int n) const {
+        __m256i biased = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(-128 - lo)));
+        return bits(_mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + n)), biased));
+    }
+#else
+    static constexpr size_t width = 16;
+    __m128i v;
+    explicit Block(const char* p) : v(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+    static uint32_t bits(__m128i m) { return static_cast<uint32_t>(_mm_movemask_epi8(m)); }
+    uint32_t eq(char c) const { return bits(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))); }
+    uint32_t inRange(char lo, int n) const {
+        __m128i biased = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(-128 - lo)));
+        return bits(_mm_cmplt_epi8(biased, _mm_set1_epi8(static_cast<char>(-128 + n))));
+    }
+#endif
+    static constexpr uint32_t full = static_cast<uint32_t>((uint64_t(1) << width) - 1);
+
+    uint32_t whitespace() const { return eq(' ') | inRange('\t', 5); }
+    uint32_t identifier() const {
+        return inRange('a', 26) | inRange('A', 26) | inRange('0', 10) | eq('_');
+    }
+};
+
+#endif
+
+} // namespace
+
+size_t skipWhitespace(std::string_view src, size_t pos, LineTable& lines) {
+    const char* data = src.data();
+    size_t end = src.size();
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (pos + Block::width <= end) {
+        Block block(data + pos);
+        uint32_t stop = ~block.whitespace() & Block::full;
+        size_t count = stop ? __builtin_ctz(stop) : Block::width;
+        recordNewlines(block.eq('\n') & lowBits(count), pos, lines);
+        pos += count;
+        if (stop) return pos;
+    }
+#endif
+    while (pos < end && isWhitespaceByte(data[pos])) {
+        if (data[pos] == '\n') lines.addLineStart(static_cast<uint32_t>(pos + 1));
+        pos++;
+    }
+    return pos;
+}
+
+size_t findLineEnd(std::string_view src, size_t pos) {
+    const char* data = src.data();
+    size_t end = src.size();
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (pos + Block::width <= end) {
+        uint32_t hit = Block(data + pos).eq('\n');
+        if (hit) return pos + __builtin_ctz(hit);
+        pos += Block::width;
+    }
+#endif
+    while (pos < end && data[pos] != '\n') pos++;
+    return pos;
+}
+
+size_t findStringEnd(std::string_view src, size_t pos, LineTable& lines) {
+    const char* data = src.data();
+    size_t end = src.size();
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (pos + Block::width <= end) {
+        Block block(data + pos);
+        uint32_t stop = block.eq('"');
+        size_t count = stop ? __builtin_ctz(stop) : Block::width;
+        recordNewlines(block.eq('\n') & lowBits(count), pos, lines);
+        pos += count;
+        if (stop) return pos;
+    }
+#endif
+    while (pos < end && data[pos] != '"') {
+        if (data[pos] == '\n') lines.addLineStart(static_cast<uint32_t>(pos + 1));
+        pos++;
+    }
+    return pos;
+}
+
+size_t scanIdentifier(std::string_view src, size_t pos) {
+    const char* data = src.data();
+    size_t end = src.size();
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (pos + Block::width <= end) {
+        uint32_t stop = ~Block(data + pos).identifier() & Block::full;
+        if (stop) return pos + __builtin_ctz(stop);
+        pos += Block::width;
+    }
+#endif
+    while (pos < end && isIdentifierByte(data[pos])) pos++;
+    return pos;
+}
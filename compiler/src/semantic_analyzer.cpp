@@ -2,57 +2,15 @@
 #include <iostream>
 #include <stdexcept>
 #include <set>
-#include <cstring>
-
-// Helper to get size of a type
-int SemanticAnalyzer::getTypeSize(const TypeNode* type) {
-    if (!type) {
-        throw std::runtime_error("Semantic Error: Attempted to get size of a null type.");
-    }
-
-    switch (type->category) {
-        case TypeNode::TypeCategory::PRIMITIVE: {
-            const PrimitiveTypeNode* prim_type = static_cast<const PrimitiveTypeNode*>(type);
-            switch (prim_type->primitive_type) {
-                case Token::KEYWORD_INT: return 4; // 4 bytes for int (dword)
-                case Token::KEYWORD_FLOAT: return 4; // 4 bytes for float (dword)
-                case Token::KEYWORD_DOUBLE: return 8; // 8 bytes for double (qword)
-                case Token::KEYWORD_BOOL: return 1; // 1 byte for bool
-                case Token::KEYWORD_CHAR: return 1; // 1 byte for char
-                case Token::KEYWORD_STRING: return 8; // 8 bytes for string (pointer)
-                case Token::KEYWORD_VOID: return 0; // Void has no size
-                default: throw std::runtime_error("Semantic Error: Unknown primitive type for size calculation.");
-            }
-        }
-        case TypeNode::TypeCategory::POINTER:
-            return 8; // Pointers are 8 bytes on x64
-        case TypeNode::TypeCategory::ARRAY: {
-            const ArrayTypeNode* array_type = static_cast<const ArrayTypeNode*>(type);
-            if (array_type->size <= 0) {
-                throw std::runtime_error("Semantic Error: Unsized arrays not allowed for local variables.");
-            }
-            int element_size = getTypeSize(array_type->base_type.get());
-            if (array_type->size > 0) {
-                return element_size * array_type->size;
-            }
-            return 0; 
-        }
-        case TypeNode::TypeCategory::STRUCT: {
-            const StructTypeNode* struct_type = static_cast<const StructTypeNode*>(type);
-            if (!symbolTable.isStructDefined(struct_type->struct_name)) {
-                throw std::runtime_error("Semantic Error: Undefined struct '" + struct_type->struct_name + "'.");
-            }
-            return symbolTable.getStructDefinitions()[struct_type->struct_name]->size;
-        }
-        default:
-            throw std::runtime_error("Semantic Error: Unknown type category for size calculation.");
-    }
-}
+#include <algorithm>
 
 bool SemanticAnalyzer::areTypesCompatible(const TypeNode* type1, const TypeNode* type2) {
     if (!type1 || !type2) {
         return false; // Null types are not compatible
     }
+    if (type1 == type2) {
+        return true; // Types are interned, the same type is always the same node
+    }
 
     auto isString = [](const TypeNode* t) {
         if (t->category != TypeNode::TypeCategory::PRIMITIVE) return false;
@@ -75,32 +33,38 @@ bool SemanticAnalyzer::areTypesCompatible(const TypeNode* type1, const TypeNode*
     }
 
     switch (type1->category) {
-        case TypeNode::TypeCategory::PRIMITIVE: {
-            const PrimitiveTypeNode* p1 = static_cast<const PrimitiveTypeNode*>(type1);
-            const PrimitiveTypeNode* p2 = static_cast<const PrimitiveTypeNode*>(type2);
-            return p1->primitive_type == p2->primitive_type;
-        }
+        case TypeNode::TypeCategory::PRIMITIVE:
+            return false; // Distinct primitive types
         case TypeNode::TypeCategory::POINTER: {
             const PointerTypeNode* ptr1 = static_cast<const PointerTypeNode*>(type1);
             const PointerTypeNode* ptr2 = static_cast<const PointerTypeNode*>(type2);
-            return areTypesCompatible(ptr1->base_type.get(), ptr2->base_type.get());
+            return areTypesCompatible(ptr1->base_type, ptr2->base_type);
         }
         case TypeNode::TypeCategory::ARRAY: {
             const ArrayTypeNode* arr1 = static_cast<const ArrayTypeNode*>(type1);
             const ArrayTypeNode* arr2 = static_cast<const ArrayTypeNode*>(type2);
-            return areTypesCompatible(arr1->base_type.get(), arr2->base_type.get());
-        }
-        case TypeNode::TypeCategory::STRUCT: {
-            const StructTypeNode* s1 = static_cast<const StructTypeNode*>(type1);
-            const StructTypeNode* s2 = static_cast<const StructTypeNode*>(type2);
-            return s1->struct_name == s2->struct_name;
+            return areTypesCompatible(arr1->base_type, arr2->base_type);
         }
+        case TypeNode::TypeCategory::STRUCT:
+            return false; // One node per struct name, so these are different structs
         default:
             return false; // Unknown category
     }
 }
 
 void SemanticAnalyzer::analyze() {
+    analyzeDeclarations();
+
+    // Now visit function bodies — but do NOT exit their scopes
+    for (const auto& func_node : program_ast->functions) {
+        analyzeFunction(func_node.get());
+        // DO NOT exit scope — code generator needs it
+    }
+
+    checkEntryPoint();
+}
+
+void SemanticAnalyzer::analyzeDeclarations() {
     symbolTable.enterScope(); // global scope
 
     // Process structs
@@ -110,38 +74,28 @@ void SemanticAnalyzer::analyze() {
 
     // Declare functions (but don't visit bodies yet)
     for (const auto& func_node : program_ast->functions) {
-        std::unique_ptr<TypeNode> return_type = func_node->return_type->clone();
-        std::vector<std::unique_ptr<TypeNode>> param_types;
-        for (const auto& param : func_node->parameters) {
-            param_types.push_back(param->type->clone());
-        }
-
-        std::string mangled = Mangler::mangleFunction(namespace_stack, func_node->name);
-
-        Symbol func_symbol(Symbol::SymbolType::FUNCTION, std::string(func_node->name), std::move(return_type), std::move(param_types));
-        func_symbol.mangled_name = mangled;
-        //std::cout << func_symbol.name << ": " << func_symbol.mangled_name << std::endl;
-        symbolTable.addSymbol(std::move(func_symbol));
+        symbolTable.addFunction(*func_node, intern(Mangler::mangleFunction(namespace_stack, func_node->name)));
     }
 
     // Process global statements
     for (const auto& stmt : program_ast->statements) {
         visit(stmt.get());
     }
+}
 
-    // Now visit function bodies — but do NOT exit their scopes
-    for (const auto& func_node : program_ast->functions) {
-        visit(func_node.get());
-        // DO NOT exit scope — code generator needs it
-    }
+void SemanticAnalyzer::analyzeFunction(FunctionDefinitionNode* func_node) {
+    visit(func_node);
+}
 
+void SemanticAnalyzer::checkEntryPoint() {
     // Check for main
     bool has_main = false;
+    const Ident main_ident = intern("main");
     for (const auto& func : program_ast->functions) {
-        if (func->name == "main") {
+        if (func->name == main_ident) {
             has_main = true;
             if (func->return_type->category != TypeNode::TypeCategory::PRIMITIVE ||
-                static_cast<PrimitiveTypeNode*>(func->return_type.get())->primitive_type != Token::KEYWORD_INT) {
+                static_cast<const PrimitiveTypeNode*>(func->return_type)->primitive_type != Token::KEYWORD_INT) {
                 throw std::runtime_error("Semantic Error: 'main' function must return int.");
                 }
                 if (!func->parameters.empty()) {
@@ -156,118 +110,44 @@ void SemanticAnalyzer::analyze() {
     //symbolTable.exitScope();
 }
 
+// Errors are thrown without a position; the innermost node with one adds it here.
+// Both visit() and visitExpression() go through this, so an error inside an expression
+// points at the expression, not at the statement holding it.
+template <typename Run>
+auto SemanticAnalyzer::locateErrors(ASTNode* node, Run&& run) -> decltype(run()) {
+    try {
+        return run();
+    } catch (const std::runtime_error& e) {
+        if (error_located || node->loc == NO_LOC) throw;
+        error_located = true;
+        std::string message = e.what();
+        bool period = !message.empty() && message.back() == '.';
+        if (period) message.pop_back();
+        throw std::runtime_error(message + " at " + SourceManager::global().describe(node->loc) + (period ? "." : ""));
+    }
+}
+
 void SemanticAnalyzer::visit(ASTNode* node) {
     if (!node) return;
-
-    switch (node->node_type) {
-        case ASTNode::NodeType::PROGRAM:
-            visit(static_cast<ProgramNode*>(node));
-            break;
-        case ASTNode::NodeType::FUNCTION_DEFINITION:
-            visit(static_cast<FunctionDefinitionNode*>(node));
-            break;
-        case ASTNode::NodeType::VARIABLE_DECLARATION:
-            visit(static_cast<VariableDeclarationNode*>(node));
-            break;
-        case ASTNode::NodeType::VARIABLE_ASSIGNMENT:
-            visit(static_cast<VariableAssignmentNode*>(node));
-            break;
-        case ASTNode::NodeType::VARIABLE_REFERENCE:
-            visit(static_cast<VariableReferenceNode*>(node));
-            break;
-        case ASTNode::NodeType::BINARY_OPERATION_EXPRESSION:
-            visit(static_cast<BinaryOperationExpressionNode*>(node));
-            break;
-        case ASTNode::NodeType::PRINT_STATEMENT:
-            visit(static_cast<PrintStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::RETURN_STATEMENT:
-            visit(static_cast<ReturnStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::IF_STATEMENT:
-            visit(static_cast<IfStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::WHILE_STATEMENT:
-            visit(static_cast<WhileStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::FOR_STATEMENT:
-            visit(static_cast<ForStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::FUNCTION_CALL:
-            visit(static_cast<FunctionCallNode*>(node));
-            break;
-        case ASTNode::NodeType::MEMBER_ACCESS_EXPRESSION:
-            visit(static_cast<MemberAccessNode*>(node));
-            break;
-        case ASTNode::NodeType::UNARY_OP_EXPRESSION:
-            visit(static_cast<UnaryOpExpressionNode*>(node));
-            break;
-        case ASTNode::NodeType::ARRAY_ACCESS_EXPRESSION:
-            visit(static_cast<ArrayAccessNode*>(node));
-            break;
-        case ASTNode::NodeType::STRUCT_DEFINITION:
-            visit(static_cast<StructDefinitionNode*>(node));
-            break;
-        case ASTNode::NodeType::NAMESPACE_DEFINITION:
-            visit(static_cast<NamespaceDefinition*>(node));
-            break;
-        case ASTNode::NodeType::SCOPE_RESOLUTION:
-            visit(static_cast<ScopeResolutionNode*>(node));
-            break;
-        case ASTNode::NodeType::FLOAT_LITERAL_EXPRESSION: {
-            auto* lit = static_cast<FloatLiteralExpressionNode*>(node);
-            lit->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_FLOAT);
-            break;
-        }
-        case ASTNode::NodeType::DOUBLE_LITERAL_EXPRESSION: {
-            auto* lit = static_cast<DoubleLiteralExpressionNode*>(node);
-            lit->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_DOUBLE);
-            break;
-        }
-        case ASTNode::NodeType::INTEGER_LITERAL_EXPRESSION: {
-            auto* lit = static_cast<IntegerLiteralExpressionNode*>(node);
-            lit->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_INT);
-            break;
-        }
-        case ASTNode::NodeType::STRING_LITERAL_EXPRESSION:
-        case ASTNode::NodeType::BOOLEAN_LITERAL_EXPRESSION:
-        case ASTNode::NodeType::CHARACTER_LITERAL_EXPRESSION:
-            break;
-        case ASTNode::NodeType::ASM_STATEMENT:
-            visit(static_cast<AsmStatementNode*>(node));
-            break;
-        case ASTNode::NodeType::CONSTANT_DECLARATION:
-            visit(static_cast<ConstantDeclarationNode*>(node));
-            break;
-        case ASTNode::NodeType::ENUM_STATEMENT:
-            visit(static_cast<EnumStatementNode*>(node));
-            break;
-        default:
-            throw std::runtime_error("Semantic Error: Unknown AST node type encountered during analysis.");
-    }
+    locateErrors(node, [this, node] { dispatch(node); });
 }
 
+// A literal used as a statement only needs its type
+void SemanticAnalyzer::visit(IntegerLiteralExpressionNode* node) { visitExpression(node); }
+void SemanticAnalyzer::visit(StringLiteralExpressionNode* node) { visitExpression(node); }
+void SemanticAnalyzer::visit(BooleanLiteralExpressionNode* node) { visitExpression(node); }
+void SemanticAnalyzer::visit(CharacterLiteralExpressionNode* node) { visitExpression(node); }
+void SemanticAnalyzer::visit(FloatLiteralExpressionNode* node) { visitExpression(node); }
+void SemanticAnalyzer::visit(DoubleLiteralExpressionNode* node) { visitExpression(node); }
+
 void SemanticAnalyzer::visit(ProgramNode* node) {
 }
 
 void SemanticAnalyzer::visit(FunctionDefinitionNode* node) {
-std::vector<std::unique_ptr<TypeNode>> paramTypes;
-    for (const auto& param : node->parameters) {
-        paramTypes.push_back(param->type->clone());
-    }
-
-    Symbol func_symbol(
-        Symbol::SymbolType::FUNCTION, 
-        node->name, 
-        node->return_type->clone(), 
-        std::move(paramTypes)
-    );
-
-    func_symbol.mangled_name = Mangler::mangleFunction(namespace_stack, node->name);
-    node->mangled_name = func_symbol.mangled_name;
-
-    symbolTable.addSymbol(std::move(func_symbol)); 
+    node->mangled_name = Mangler::mangleFunction(namespace_stack, node->name);
+    symbolTable.addFunction(*node, intern(node->mangled_name));
 
+    size_t first_scope = symbolTable.all_scopes.size();
     symbolTable.enterScope();
 
     currentFunctionReturnType = nullptr;
@@ -278,19 +158,19 @@ std::vector<std::unique_ptr<TypeNode>> paramTypes;
 
     for (int i = 0; i < node->parameters.size(); ++i) {
         const auto& param = node->parameters[i];
-        int size = getTypeSize(param->type.get());
+        int size = typeSize(param->type);
         if (i < arg_registers.size()) {
             register_param_offset -= 8; 
-            symbolTable.addSymbol(Symbol(Symbol::SymbolType::VARIABLE, param->name, param->type->clone(), register_param_offset, size));
+            symbolTable.addVariable(param->name, param->type, register_param_offset);
         } else {
-            symbolTable.addSymbol(Symbol(Symbol::SymbolType::VARIABLE, param->name, param->type->clone(), param_offset, size));
+            symbolTable.addVariable(param->name, param->type, param_offset);
             param_offset += size;
         }
     }
 
     symbolTable.current_scope->currentOffset = register_param_offset;
 
-    currentFunctionReturnType = node->return_type.get();
+    currentFunctionReturnType = node->return_type;
 
     if (!node->is_extern) {
         for (const auto& stmt : node->body_statements) {
@@ -298,65 +178,69 @@ std::vector<std::unique_ptr<TypeNode>> paramTypes;
         }
     }
 
+    for (size_t i = first_scope; i < symbolTable.all_scopes.size(); ++i) {
+        node->frame_size = std::max(node->frame_size, -symbolTable.all_scopes[i]->currentOffset);
+    }
+
     currentFunctionReturnType = nullptr;
     symbolTable.exitScope();
 }
 
 void SemanticAnalyzer::visit(VariableDeclarationNode* node) {
-    bool is_auto = (dynamic_cast<AutoTypeNode*>(node->type.get()) != nullptr);
+    bool is_auto = (dynamic_cast<const AutoTypeNode*>(node->type) != nullptr);
 
     for (auto& decl : node->declarations) {
         if (symbolTable.current_scope->lookup(decl.name)) {
-            throw std::runtime_error("Semantic Error: Redefinition of variable '" + decl.name + "'.");
+            throw std::runtime_error("Semantic Error: Redefinition of variable '" + spelling(decl.name) + "'.");
         }
 
-        std::unique_ptr<TypeNode> actual_type;
+        const TypeNode* actual_type;
 
         if (is_auto) {
             if (!decl.initial_value) {
-                throw std::runtime_error("Semantic Error: 'auto' variable '" + decl.name + "' requires an initializer.");
+                throw std::runtime_error("Semantic Error: 'auto' variable '" + spelling(decl.name) + "' requires an initializer.");
             }
             actual_type = visitExpression(decl.initial_value.get());
             if (!actual_type) {
-                throw std::runtime_error("Semantic Error: Could not deduce type for 'auto' variable '" + decl.name + "'.");
+                throw std::runtime_error("Semantic Error: Could not deduce type for 'auto' variable '" + spelling(decl.name) + "'.");
             }
         } else {
-            actual_type = node->type->clone();
+            actual_type = node->type;
             if (decl.initial_value) {
                 auto expr_type = visitExpression(decl.initial_value.get());
-                if (!areTypesCompatible(expr_type.get(), actual_type.get())) throw std::runtime_error("Type mismatch for '" + decl.name + "'");
+                if (!areTypesCompatible(expr_type, actual_type)) throw std::runtime_error("Type mismatch for '" + spelling(decl.name) + "'");
             }
         }
 
         if (!actual_type) {
-            throw std::runtime_error("Semantic Error: Type deduction failed for '" + decl.name + "'.");
+            throw std::runtime_error("Semantic Error: Type deduction failed for '" + spelling(decl.name) + "'.");
         }
 
-        int var_size = getTypeSize(actual_type.get());
-        symbolTable.current_scope->currentOffset -= var_size;
+        // The variable itself lives at its label in .data, which gets the full alignment.
+        // Its frame slot is only offset from rbp, and rbp is 16-byte aligned, so padding the
+        // slot for more than that would buy nothing.
+        int var_size = typeSize(actual_type);
+        int slot_align = std::min(std::max(typeAlign(actual_type), node->align), 16);
+        symbolTable.current_scope->currentOffset = -alignUp(var_size - symbolTable.current_scope->currentOffset, slot_align);
         int offset = symbolTable.current_scope->currentOffset;
 
-        std::string unique_label = Mangler::mangleVariable(namespace_stack, decl.name);
-
-        Symbol symbol(Symbol::SymbolType::VARIABLE, decl.name, actual_type->clone(), offset, var_size);
-        symbol.mangled_name = unique_label;
-        decl.resolved_symbol = symbolTable.addSymbol(std::move(symbol));
+        Ident unique_label = intern(Mangler::mangleVariable(namespace_stack, decl.name));
+        decl.resolved_symbol = symbolTable.addVariable(decl.name, actual_type, offset, unique_label);
     }
 }
 
 void SemanticAnalyzer::visit(VariableAssignmentNode* node) {
+    const TypeNode* left_type = visitExpression(node->left.get());
     if (node->left->node_type == ASTNode::NodeType::VARIABLE_REFERENCE) {
         auto* var_ref = static_cast<VariableReferenceNode*>(node->left.get());
-        Symbol* symbol = symbolTable.lookup(var_ref->name);
-        if (symbol && symbol->type == Symbol::SymbolType::CONSTANT) {
-            throw std::runtime_error("Semantic Error: Cannot assign to constant '" + var_ref->name + "'.");
+        if (var_ref->resolved_symbol->type == Symbol::SymbolType::CONSTANT) {
+            throw std::runtime_error("Semantic Error: Cannot assign to constant '" + spelling(var_ref->name) + "'.");
         }
     }
 
-    std::unique_ptr<TypeNode> left_type = visitExpression(node->left.get());
-    std::unique_ptr<TypeNode> right_type = visitExpression(node->right.get());
+    const TypeNode* right_type = visitExpression(node->right.get());
 
-    if (!areTypesCompatible(left_type.get(), right_type.get())) {
+    if (!areTypesCompatible(left_type, right_type)) {
         throw std::runtime_error("Semantic Error: Type mismatch in assignment.");
     }
 }
@@ -364,22 +248,18 @@ void SemanticAnalyzer::visit(VariableAssignmentNode* node) {
 void SemanticAnalyzer::visit(VariableReferenceNode* node) {
     Symbol* var_symbol = symbolTable.lookup(node->name);
     if (!var_symbol) {
-        throw std::runtime_error("Semantic Error: Use of undeclared variable '" + node->name + "'.");
+        throw std::runtime_error("Semantic Error: Use of undeclared variable '" + spelling(node->name) + "'.");
     }
     node->resolved_symbol = var_symbol;
     node->resolved_offset = var_symbol->offset;
-    node->resolved_type = var_symbol->dataType->clone();
+    node->resolved_type = var_symbol->dataType;
 }
 
 void SemanticAnalyzer::visit(NamespaceDefinition* node) {
     namespace_stack.push_back(node->name);
     symbolTable.enterScope();
 
-    Scope* namespace_scope = symbolTable.current_scope;
-    Symbol ns_symbol(Symbol::SymbolType::NAMESPACE_DEFINITION, node->name, namespace_scope);
-    if (namespace_scope->parent) {
-        namespace_scope->parent->addSymbol(std::move(ns_symbol));
-    }
+    symbolTable.addNamespace(node->name, symbolTable.current_scope);
 
     for (auto& member : node->members) {
         this->visit(member.node.get());
@@ -392,31 +272,34 @@ void SemanticAnalyzer::visit(NamespaceDefinition* node) {
 void SemanticAnalyzer::visit(ScopeResolutionNode* node) {
     Symbol* ns_symbol = symbolTable.lookup(node->namespace_name);
     if (!ns_symbol || ns_symbol->type != Symbol::SymbolType::NAMESPACE_DEFINITION) {
-        throw std::runtime_error("Semantic Error: '" + node->namespace_name + "' is not a namespace.");
+        throw std::runtime_error("Semantic Error: '" + spelling(node->namespace_name) + "' is not a namespace.");
     }
 
     Scope* old_scope = symbolTable.current_scope;
-    symbolTable.current_scope = ns_symbol->internal_scope;
+    symbolTable.current_scope = symbolTable.namespaceRecord(*ns_symbol).scope;
 
     try {
         this->visit(node->member.get());
 
         if (node->member->node_type == ASTNode::NodeType::VARIABLE_REFERENCE) {
             auto* var = static_cast<VariableReferenceNode*>(node->member.get());
-            node->resolved_type = var->resolved_type->clone();
+            node->resolved_symbol = var->resolved_symbol;
+            node->resolved_type = var->resolved_type;
         } else if (node->member->node_type == ASTNode::NodeType::SCOPE_RESOLUTION) {
             auto* nested = static_cast<ScopeResolutionNode*>(node->member.get());
+            node->resolved_symbol = nested->resolved_symbol;
             if (nested->resolved_type) {
-                node->resolved_type = nested->resolved_type->clone();
+                node->resolved_type = nested->resolved_type;
             }
         } else if (node->member->node_type == ASTNode::NodeType::FUNCTION_CALL) {
             auto* call = static_cast<FunctionCallNode*>(node->member.get());
+            node->resolved_symbol = call->resolved_symbol;
             if (call->resolved_symbol && call->resolved_symbol->dataType) {
-                node->resolved_type = call->resolved_symbol->dataType->clone();
+                node->resolved_type = call->resolved_symbol->dataType;
             }
         }
         if (!node->resolved_type) {
-            throw std::runtime_error("Semantic Error: Could not resolve type for namespace member '" + node->namespace_name + "'.");
+            throw std::runtime_error("Semantic Error: Could not resolve type for namespace member '" + spelling(node->namespace_name) + "'.");
         }
 
     } catch (const std::exception& e) {
@@ -428,19 +311,19 @@ void SemanticAnalyzer::visit(ScopeResolutionNode* node) {
 }
 
 void SemanticAnalyzer::visit(BinaryOperationExpressionNode* node) {
-    std::unique_ptr<TypeNode> left_type = visitExpression(node->left.get());
-    std::unique_ptr<TypeNode> right_type = visitExpression(node->right.get());
+    const TypeNode* left_type = visitExpression(node->left.get());
+    const TypeNode* right_type = visitExpression(node->right.get());
 
-    node->left->resolved_type = left_type->clone();
-    node->right->resolved_type = right_type->clone();
+    node->left->resolved_type = left_type;
+    node->right->resolved_type = right_type;
 
     if (left_type->category != right_type->category) {
-        throw std::runtime_error("Semantic Error: Type mismatch in binary operation (cannot operate on " + typeToString(left_type.get()) + " and " + typeToString(right_type.get()) + ")");
+        throw std::runtime_error("Semantic Error: Type mismatch in binary operation (cannot operate on " + typeToString(left_type) + " and " + typeToString(right_type) + ")");
     }
 
     if (left_type->category == TypeNode::TypeCategory::PRIMITIVE) {
-        auto p1 = static_cast<PrimitiveTypeNode*>(left_type.get());
-        auto p2 = static_cast<PrimitiveTypeNode*>(right_type.get());
+        auto p1 = static_cast<const PrimitiveTypeNode*>(left_type);
+        auto p2 = static_cast<const PrimitiveTypeNode*>(right_type);
         if (p1->primitive_type != p2->primitive_type) {
             throw std::runtime_error("Semantic Error: Mixed math. Adding different primitive types is not yet supported.");
         }
@@ -453,20 +336,20 @@ void SemanticAnalyzer::visit(BinaryOperationExpressionNode* node) {
         case Token::GREATER:
         case Token::LESS_EQUAL:
         case Token::GREATER_EQUAL:
-            node->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_BOOL);
+            node->resolved_type = primitiveType(Token::KEYWORD_BOOL);
             break;
         default:
             if (left_type) {
-                std::cout << "Debug: Binary Op resolving to: " << typeToString(left_type.get()) << std::endl;
+                std::cout << "Debug: Binary Op resolving to: " << typeToString(left_type) << std::endl;
             }
-            node->resolved_type = left_type->clone();
+            node->resolved_type = left_type;
             break;
     }
 }
 
 void SemanticAnalyzer::visit(PrintStatementNode* node) {
     for (const auto& expr : node->expressions) {
-        expr->resolved_type = std::move(visitExpression(expr.get()));
+        expr->resolved_type = visitExpression(expr.get());
         if (!expr->resolved_type) throw std::runtime_error("Semantic Error: Could not resolve type for print expression.");
     }
 }
@@ -476,20 +359,20 @@ void SemanticAnalyzer::visit(ReturnStatementNode* node) {
         node->resolved_type = visitExpression(node->expression.get());
 
         if (currentFunctionReturnType->category == TypeNode::TypeCategory::PRIMITIVE) {
-            auto prim = static_cast<PrimitiveTypeNode*>(currentFunctionReturnType);
+            auto prim = static_cast<const PrimitiveTypeNode*>(currentFunctionReturnType);
             if (prim->primitive_type == Token::KEYWORD_VOID) {
                 throw std::runtime_error("Semantic Error: Cannot return a value from a void function.");
             }
-            if (!areTypesCompatible(node->resolved_type.get(), currentFunctionReturnType)) {
+            if (!areTypesCompatible(node->resolved_type, currentFunctionReturnType)) {
                 throw std::runtime_error("Semantic Error: Return type mismatch in function.");
             }
         }
     } else {
-        node->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_VOID);
+        node->resolved_type = primitiveType(Token::KEYWORD_VOID);
 
         bool isFunctionVoid = false;
         if (currentFunctionReturnType->category == TypeNode::TypeCategory::PRIMITIVE) {
-            auto prim = static_cast<PrimitiveTypeNode*>(currentFunctionReturnType);
+            auto prim = static_cast<const PrimitiveTypeNode*>(currentFunctionReturnType);
             if (prim->primitive_type == Token::KEYWORD_VOID) {
                 isFunctionVoid = true;
             }
@@ -501,9 +384,9 @@ void SemanticAnalyzer::visit(ReturnStatementNode* node) {
 }
 
 void SemanticAnalyzer::visit(IfStatementNode* node) {
-    std::unique_ptr<TypeNode> cond_type = visitExpression(node->condition.get());
+    const TypeNode* cond_type = visitExpression(node->condition.get());
     if (cond_type->category != TypeNode::TypeCategory::PRIMITIVE ||
-        static_cast<PrimitiveTypeNode*>(cond_type.get())->primitive_type != Token::KEYWORD_BOOL && static_cast<PrimitiveTypeNode*>(cond_type.get())->primitive_type != Token::INTEGER_LITERAL) {
+        static_cast<const PrimitiveTypeNode*>(cond_type)->primitive_type != Token::KEYWORD_BOOL && static_cast<const PrimitiveTypeNode*>(cond_type)->primitive_type != Token::INTEGER_LITERAL) {
         throw std::runtime_error("Semantic Error: If condition must be a boolean expression.");
     }
 
@@ -516,9 +399,9 @@ void SemanticAnalyzer::visit(IfStatementNode* node) {
 }
 
 void SemanticAnalyzer::visit(SwitchStatementNode* node) {
-    std::unique_ptr<TypeNode> cond_type = visitExpression(node->condition.get());
+    const TypeNode* cond_type = visitExpression(node->condition.get());
     if (cond_type->category != TypeNode::TypeCategory::PRIMITIVE ||
-        dynamic_cast<PrimitiveTypeNode*>(cond_type.get())->primitive_type != Token::KEYWORD_INT) {
+        dynamic_cast<const PrimitiveTypeNode*>(cond_type)->primitive_type != Token::KEYWORD_INT) {
         throw std::runtime_error("Semantic Error: Switch condition must be an integer value.");
     }
 
@@ -562,9 +445,9 @@ void SemanticAnalyzer::visit(SwitchStatementNode* node) {
 }
 
 void SemanticAnalyzer::visit(WhileStatementNode* node) {
-    std::unique_ptr<TypeNode> cond_type = visitExpression(node->condition.get());
+    const TypeNode* cond_type = visitExpression(node->condition.get());
     if (cond_type->category != TypeNode::TypeCategory::PRIMITIVE ||
-        static_cast<PrimitiveTypeNode*>(cond_type.get())->primitive_type != Token::KEYWORD_BOOL) {
+        static_cast<const PrimitiveTypeNode*>(cond_type)->primitive_type != Token::KEYWORD_BOOL) {
         throw std::runtime_error("Semantic Error: While condition must be a boolean expression.");
     }
 
@@ -582,9 +465,9 @@ void SemanticAnalyzer::visit(ForStatementNode* node) {
         visit(node->initializer.get());
     }
     if (node->condition) {
-        std::unique_ptr<TypeNode> cond_type = visitExpression(node->condition.get());
+        const TypeNode* cond_type = visitExpression(node->condition.get());
         if (cond_type->category != TypeNode::TypeCategory::PRIMITIVE ||
-            static_cast<PrimitiveTypeNode*>(cond_type.get())->primitive_type != Token::KEYWORD_BOOL) {
+            static_cast<const PrimitiveTypeNode*>(cond_type)->primitive_type != Token::KEYWORD_BOOL) {
             throw std::runtime_error("Semantic Error: For loop condition must be a boolean expression.");
         }
     }
@@ -601,123 +484,112 @@ void SemanticAnalyzer::visit(ForStatementNode* node) {
 void SemanticAnalyzer::visit(FunctionCallNode* node) {
     Symbol* func_symbol = symbolTable.lookup(node->function_name);
     if (!func_symbol || func_symbol->type != Symbol::SymbolType::FUNCTION) {
-        throw std::runtime_error("Semantic Error: Call to undeclared function '" + node->function_name + "'.");
+        throw std::runtime_error("Semantic Error: Call to undeclared function '" + spelling(node->function_name) + "'.");
     }
     node->resolved_symbol = func_symbol;
 
     // Check number of arguments
-    if (node->arguments.size() != func_symbol->parameterTypes.size()) {
-        throw std::runtime_error("Semantic Error: Function '" + node->function_name + "' expects " +
-                                 std::to_string(func_symbol->parameterTypes.size()) + " arguments, but " +
+    size_t param_count = symbolTable.function(*func_symbol).param_count;
+    if (node->arguments.size() != param_count) {
+        throw std::runtime_error("Semantic Error: Function '" + spelling(node->function_name) + "' expects " +
+                                 std::to_string(param_count) + " arguments, but " +
                                  std::to_string(node->arguments.size()) + " were provided.");
     }
 
     // Check argument types
     for (size_t i = 0; i < node->arguments.size(); ++i) {
-        std::unique_ptr<TypeNode> arg_type = visitExpression(node->arguments[i].get());
-        node->arguments[i]->resolved_type = arg_type->clone();
-        if (!areTypesCompatible(arg_type.get(), func_symbol->parameterTypes[i].get())) {
+        const TypeNode* arg_type = visitExpression(node->arguments[i].get());
+        node->arguments[i]->resolved_type = arg_type;
+        if (!areTypesCompatible(arg_type, symbolTable.parameterType(*func_symbol, i))) {
             throw std::runtime_error("Semantic Error: Type mismatch in argument " + std::to_string(i + 1) +
-                                     " of function '" + node->function_name + "'.");
+                                     " of function '" + spelling(node->function_name) + "'.");
         }
     }
-    if (func_symbol->dataType) node->resolved_type = func_symbol->dataType->clone();
-    else throw std::runtime_error("Semantic Error: Function '" + node->function_name + "' has no return type.");
+    if (func_symbol->dataType) node->resolved_type = func_symbol->dataType;
+    else throw std::runtime_error("Semantic Error: Function '" + spelling(node->function_name) + "' has no return type.");
 }
 
 
 void SemanticAnalyzer::visit(MemberAccessNode* node) {
     if (debug_mode) std::cout << "Debug: Entering visit for node: " << node << std::endl;
-    std::unique_ptr<TypeNode> base_type = visitExpression(node->struct_expr.get());
+    const TypeNode* base_type = visitExpression(node->struct_expr.get());
 
     if (base_type->category != TypeNode::TypeCategory::STRUCT) {
         throw std::runtime_error("Semantic Error: Member access operator '.' used on non-struct type.");
     }
 
-    const StructTypeNode* struct_type = static_cast<const StructTypeNode*>(base_type.get());
+    const StructTypeNode* struct_type = static_cast<const StructTypeNode*>(base_type);
 
-    if (!symbolTable.isStructDefined(struct_type->struct_name)) {
+    const StructDefinitionNode* struct_def = struct_type->definition;
+    if (!struct_def) {
         throw std::runtime_error("Semantic Error: Undefined struct '" + struct_type->struct_name + "'.");
     }
 
-    const auto& definitions = symbolTable.getStructDefinitions(); 
-    auto it = definitions.find(struct_type->struct_name);
-    if (it == definitions.end()) {
-        throw std::runtime_error("Struct not found in registry during access");
-    }
-    auto* struct_def = it->second;
-
     if (debug_mode) std::cout << "Debug: Struct '" << struct_type->struct_name << "' has " << struct_def->members.size() << " members in the registry." << std::endl;
     bool member_found = false;
 
      for (const auto& member : struct_def->members) {
-        if (strcmp(member.name.c_str(), node->member_name.c_str()) == 0) {
+        if (member.name == node->member_name) {
             member_found = true;
 
             // Check visibility
             if (member.visibility == StructMember::Visibility::PRIVATE) {
                 // A more complex check would be needed for friend classes or member functions
-                throw std::runtime_error("Semantic Error: Cannot access private member '" + node->member_name + "' of struct '" + struct_type->struct_name + "'.");
+                throw std::runtime_error("Semantic Error: Cannot access private member '" + spelling(node->member_name) + "' of struct '" + struct_type->struct_name + "'.");
             }
 
-            node->resolved_symbol = new Symbol(Symbol::SymbolType::STRUCT_MEMBER, member.name, member.type->clone(), member.offset, getTypeSize(member.type.get()), member.visibility);
-            node->resolved_type = member.type->clone();
+            node->resolved_symbol = member.symbol;
+            node->resolved_type = member.type;
             return;
         }
     }
 
     if (!member_found) {
-        throw std::runtime_error("Semantic Error: Struct '" + struct_type->struct_name + "' has no member named '" + node->member_name + "'.");
+        throw std::runtime_error("Semantic Error: Struct '" + struct_type->struct_name + "' has no member named '" + spelling(node->member_name) + "'.");
     }
 }
 
 void SemanticAnalyzer::visit(StructDefinitionNode* node) {
-    // Calculate offsets
-    int offset = 0;
+    LayoutTable::global().layoutStruct(*node);
     for (auto& member : node->members) {
-        member.offset = offset;
-        offset += getTypeSize(member.type.get());
+        member.symbol = symbolTable.addMember(member);
     }
-    node->size = offset;
-
-    // Register in symbol table
-    symbolTable.addStructDefinition(node->name, node);
 }
 
 void SemanticAnalyzer::visit(UnaryOpExpressionNode* node) {
-    std::unique_ptr<TypeNode> operand_type = visitExpression(node->operand.get());
+    const TypeNode* operand_type = visitExpression(node->operand.get());
 
     if (node->op_type == Token::ADDRESSOF) {
         if (node->operand->node_type != ASTNode::NodeType::VARIABLE_REFERENCE) {
             throw std::runtime_error("Semantic Error: Address-of operator '&' can only be applied to variables.");
         }
         node->resolved_symbol = static_cast<VariableReferenceNode*>(node->operand.get())->resolved_symbol;
-        node->resolved_type = std::make_unique<PointerTypeNode>(std::move(operand_type));
+        node->resolved_type = pointerType(operand_type);
     } else if (node->op_type == Token::STAR) {
         if (operand_type->category != TypeNode::TypeCategory::POINTER) {
             throw std::runtime_error("Semantic Error: Dereference operator '*' can only be applied to pointer types.");
         }
-        node->resolved_type = static_cast<PointerTypeNode*>(operand_type.get())->base_type->clone();
+        node->resolved_type = static_cast<const PointerTypeNode*>(operand_type)->base_type;
     } else if (node->op_type == Token::BANG) {
-	node->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::INTEGER_LITERAL);
+	node->resolved_type = primitiveType(Token::INTEGER_LITERAL);
     } else {
         throw std::runtime_error("Semantic Error: Unknown unary operator.");
     }
 }
 
 void SemanticAnalyzer::visit(ArrayAccessNode* node) {
-    std::unique_ptr<TypeNode> array_type = visitExpression(node->array_expr.get());
-    std::unique_ptr<TypeNode> index_type = visitExpression(node->index_expr.get());
+    const TypeNode* array_type = visitExpression(node->array_expr.get());
+    const TypeNode* index_type = visitExpression(node->index_expr.get());
 
     if (array_type->category != TypeNode::TypeCategory::ARRAY) {
         throw std::runtime_error("Semantic Error: Array access operator '[]' used on non-array type.");
     }
 
     if (index_type->category != TypeNode::TypeCategory::PRIMITIVE ||
-        static_cast<PrimitiveTypeNode*>(index_type.get())->primitive_type != Token::KEYWORD_INT) {
+        static_cast<const PrimitiveTypeNode*>(index_type)->primitive_type != Token::KEYWORD_INT) {
         throw std::runtime_error("Semantic Error: Array index must be an integer.");
     }
-    node->resolved_type = static_cast<ArrayTypeNode*>(array_type.get())->base_type->clone();
+    node->resolved_type = static_cast<const ArrayTypeNode*>(array_type)->base_type;
 }
 
 void SemanticAnalyzer::visit(AsmStatementNode* node) {
@@ -726,7 +598,7 @@ void SemanticAnalyzer::visit(AsmStatementNode* node) {
 
 void SemanticAnalyzer::visit(ConstantDeclarationNode* node) {
     if (symbolTable.current_scope->lookup(node->name)) {
-        throw std::runtime_error("Semantic Error: Redefinition of symbol '" + node->name + "'.");
+        throw std::runtime_error("Semantic Error: Redefinition of symbol '" + spelling(node->name) + "'.");
     }
 
     // Ensure the initializer is a literal
@@ -739,54 +611,50 @@ void SemanticAnalyzer::visit(ConstantDeclarationNode* node) {
         throw std::runtime_error("Semantic Error: Constant initializer must be a literal value.");
     }
 
-    std::unique_ptr<TypeNode> expr_type = visitExpression(node->initial_value.get());
-    if (!areTypesCompatible(expr_type.get(), node->type.get())) {
-        throw std::runtime_error("Semantic Error: Type mismatch in constant initialization for '" + node->name + "'.");
+    const TypeNode* expr_type = visitExpression(node->initial_value.get());
+    if (!areTypesCompatible(expr_type, node->type)) {
+        throw std::runtime_error("Semantic Error: Type mismatch in constant initialization for '" + spelling(node->name) + "'.");
     }
 
-    std::unique_ptr<ASTNode> value_clone;
+    NodePtr<ASTNode> value_clone;
     switch (node->initial_value->node_type) {
         case ASTNode::NodeType::INTEGER_LITERAL_EXPRESSION:
-            value_clone = std::make_unique<IntegerLiteralExpressionNode>(static_cast<IntegerLiteralExpressionNode*>(node->initial_value.get())->value);
+            value_clone = makeNode<IntegerLiteralExpressionNode>(static_cast<IntegerLiteralExpressionNode*>(node->initial_value.get())->value);
             break;
         case ASTNode::NodeType::STRING_LITERAL_EXPRESSION:
-            value_clone = std::make_unique<StringLiteralExpressionNode>(static_cast<StringLiteralExpressionNode*>(node->initial_value.get())->value);
+            value_clone = makeNode<StringLiteralExpressionNode>(static_cast<StringLiteralExpressionNode*>(node->initial_value.get())->value);
             break;
         case ASTNode::NodeType::BOOLEAN_LITERAL_EXPRESSION:
-            value_clone = std::make_unique<BooleanLiteralExpressionNode>(static_cast<BooleanLiteralExpressionNode*>(node->initial_value.get())->value);
+            value_clone = makeNode<BooleanLiteralExpressionNode>(static_cast<BooleanLiteralExpressionNode*>(node->initial_value.get())->value);
             break;
         case ASTNode::NodeType::CHARACTER_LITERAL_EXPRESSION:
-            value_clone = std::make_unique<CharacterLiteralExpressionNode>(static_cast<CharacterLiteralExpressionNode*>(node->initial_value.get())->value);
+            value_clone = makeNode<CharacterLiteralExpressionNode>(static_cast<CharacterLiteralExpressionNode*>(node->initial_value.get())->value);
             break;
         case ASTNode::NodeType::FLOAT_LITERAL_EXPRESSION:
-            value_clone = std::make_unique<FloatLiteralExpressionNode>(static_cast<FloatLiteralExpressionNode*>(node->initial_value.get())->value);
+            value_clone = makeNode<FloatLiteralExpressionNode>(static_cast<FloatLiteralExpressionNode*>(node->initial_value.get())->value);
             break;
         case ASTNode::NodeType::DOUBLE_LITERAL_EXPRESSION:
-            value_clone = std::make_unique<DoubleLiteralExpressionNode>(static_cast<DoubleLiteralExpressionNode*>(node->initial_value.get())->value);
+            value_clone = makeNode<DoubleLiteralExpressionNode>(static_cast<DoubleLiteralExpressionNode*>(node->initial_value.get())->value);
             break;
         default:
             // Should not happen due to the check above
             break;
     }
 
-    Symbol symbol(Symbol::SymbolType::CONSTANT, node->name, node->type->clone(), std::move(value_clone));
-    node->resolved_symbol = symbolTable.addSymbol(std::move(symbol));
+    node->resolved_symbol = symbolTable.addConstant(node->name, node->type, std::move(value_clone));
 }
 
 void SemanticAnalyzer::visit(EnumStatementNode* node) {
     if (symbolTable.current_scope->lookup(node->name)) {
-        throw std::runtime_error("Semantic Error: Redefinition of symbol '" + node->name + "'.");
+        throw std::runtime_error("Semantic Error: Redefinition of symbol '" + spelling(node->name) + "'.");
     }
 
-    auto enum_info = std::make_shared<EnumInfo>();
-    enum_info->name = node->name;
-
-    symbolTable.addSymbol(Symbol(Symbol::SymbolType::ENUM_TYPE, node->name, enum_info));
+    symbolTable.addEnum(node->name);
 
     int current_value = 0;
     for (const auto& member : node->members) {
         if (symbolTable.current_scope->lookup(member->name)) {
-            throw std::runtime_error("Semantic Error: Redefinition of symbol '" + member->name + "'.");
+            throw std::runtime_error("Semantic Error: Redefinition of symbol '" + spelling(member->name) + "'.");
         }
 
         if (member->value) {
@@ -797,152 +665,104 @@ void SemanticAnalyzer::visit(EnumStatementNode* node) {
             current_value = static_cast<IntegerLiteralExpressionNode*>(member->value.get())->value;
         }
 
-	auto value_node = std::make_unique<IntegerLiteralExpressionNode>(current_value);
-        auto type_node = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_INT);
-        symbolTable.addSymbol(Symbol(Symbol::SymbolType::CONSTANT, member->name, std::move(type_node), std::move(value_node)));
+	auto value_node = makeNode<IntegerLiteralExpressionNode>(current_value);
+        symbolTable.addConstant(member->name, primitiveType(Token::KEYWORD_INT), std::move(value_node));
 
         current_value++;
     }
 }
 
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visitExpression(ASTNode* expr) {
+const TypeNode* SemanticAnalyzer::visitExpression(ASTNode* expr) {
     if (!expr) {
         throw std::runtime_error("Semantic Error: Attempted to visit a null expression.");
     }
 
-    std::unique_ptr<TypeNode> result_type = nullptr;
+    return locateErrors(expr, [this, expr] {
+        const TypeNode* result_type = ExpressionVisitor(*this).dispatch(expr);
+        if (!result_type) throw std::runtime_error("Semantic Error: Expression resolution returned null.");
+        expr->resolved_type = result_type;
+        return result_type;
+    });
+}
 
-    switch (expr->node_type) {
-        case ASTNode::NodeType::INTEGER_LITERAL_EXPRESSION: { 
-            result_type = visitIntegerLiteralExpression(static_cast<IntegerLiteralExpressionNode*>(expr));
-            break;
-        } case ASTNode::NodeType::STRING_LITERAL_EXPRESSION: {
-            result_type = visitStringLiteralExpression(static_cast<StringLiteralExpressionNode*>(expr));
-            break;
-        } case ASTNode::NodeType::BOOLEAN_LITERAL_EXPRESSION: {
-            result_type = visitBooleanLiteralExpression(static_cast<BooleanLiteralExpressionNode*>(expr));
-            break;
-        } case ASTNode::NodeType::CHARACTER_LITERAL_EXPRESSION: {
-            result_type = visitCharacterLiteralExpression(static_cast<CharacterLiteralExpressionNode*>(expr));
-            break;
-        } case ASTNode::NodeType::FLOAT_LITERAL_EXPRESSION: {
-            result_type = visitFloatLiteralExpression(static_cast<FloatLiteralExpressionNode*>(expr));
-            break;
-        } case ASTNode::NodeType::DOUBLE_LITERAL_EXPRESSION: {
-            result_type = visitDoubleLiteralExpression(static_cast<DoubleLiteralExpressionNode*>(expr));
-            break;
-        } case ASTNode::NodeType::VARIABLE_REFERENCE: {
-            auto* var_node = static_cast<VariableReferenceNode*>(expr);
-            visit(var_node); 
-            Symbol* sym = symbolTable.lookup(var_node->name);
-            if (!sym || !sym->dataType) throw std::runtime_error("Variable not found or unresolved.");
-            result_type = sym->dataType->clone();
-            break;
-        }
-        case ASTNode::NodeType::BINARY_OPERATION_EXPRESSION: {
-            auto* bin_node = static_cast<BinaryOperationExpressionNode*>(expr);
-            visit(bin_node); 
-            if (!bin_node->resolved_type) throw std::runtime_error("Binary op failed type resolution");
-            result_type = bin_node->resolved_type->clone();
-            break;
-        }
-        case ASTNode::NodeType::FUNCTION_CALL: {
-            auto* func_node = static_cast<FunctionCallNode*>(expr);
-            visit(func_node);
-            Symbol* func_symbol = symbolTable.lookup(static_cast<FunctionCallNode*>(expr)->function_name);
-            if (!func_symbol) {
-                throw std::runtime_error("Semantic Error: Function '" + static_cast<FunctionCallNode*>(expr)->function_name + "' not found.");
-            }
-            func_node->resolved_type = func_symbol->dataType->clone(); 
-            result_type = func_node->resolved_type->clone();
-            break;
-        }
-        case ASTNode::NodeType::MEMBER_ACCESS_EXPRESSION: {
-            auto* member_node = static_cast<MemberAccessNode*>(expr);
-            visit(member_node);
-            return member_node->resolved_type->clone();
-        }
-        case ASTNode::NodeType::UNARY_OP_EXPRESSION: {
-            auto* unary_node = static_cast<UnaryOpExpressionNode*>(expr);
-            visit(unary_node);
-            if (!unary_node->resolved_type) throw std::runtime_error("Unary op failed type resolution");
-            result_type = unary_node->resolved_type->clone();
-            break;
-        }
-        case ASTNode::NodeType::ARRAY_ACCESS_EXPRESSION: {
-            visit(static_cast<ArrayAccessNode*>(expr));
-            std::unique_ptr<TypeNode> array_type = visitExpression(static_cast<ArrayAccessNode*>(expr)->array_expr.get());
-            const ArrayTypeNode* arr_type = static_cast<const ArrayTypeNode*>(array_type.get());
-            expr->resolved_type = arr_type->base_type->clone();
-            result_type = arr_type->base_type->clone();
-            break;
-        }
-        case ASTNode::NodeType::VARIABLE_ASSIGNMENT: {
-            auto* assign_node = static_cast<VariableAssignmentNode*>(expr);
-            visit(assign_node);
-            auto left_type = visitExpression(assign_node->left.get());
-            assign_node->resolved_type = left_type->clone();
-            result_type = left_type->clone();
-            break;
-        }
-        case ASTNode::NodeType::VARIABLE_DECLARATION: {
-            auto* decl_node = static_cast<VariableDeclarationNode*>(expr);
-            visit(decl_node);
-            result_type = decl_node->type->clone();
-            break;
-        }
-        case ASTNode::NodeType::SCOPE_RESOLUTION: {
-            auto* scope_node = static_cast<ScopeResolutionNode*>(expr);
-            visit(scope_node);
-            if (!scope_node->resolved_type) {
-                throw std::runtime_error("Semantic Error: Could not resolve type for namespace member.");
-            }
-            result_type = scope_node->resolved_type->clone();
-            break;
-        }
-        default:
-            throw std::runtime_error("Semantic Error: Unexpected AST node type in visitExpression.");
-    }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(IntegerLiteralExpressionNode*) { return primitiveType(Token::KEYWORD_INT); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(StringLiteralExpressionNode*) { return primitiveType(Token::KEYWORD_STRING); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(BooleanLiteralExpressionNode*) { return primitiveType(Token::KEYWORD_BOOL); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(CharacterLiteralExpressionNode*) { return primitiveType(Token::KEYWORD_CHAR); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(FloatLiteralExpressionNode*) { return primitiveType(Token::KEYWORD_FLOAT); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(DoubleLiteralExpressionNode*) { return primitiveType(Token::KEYWORD_DOUBLE); }
 
-    if (result_type) {
-        expr->resolved_type = result_type->clone();
-        return result_type;
-    }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(VariableReferenceNode* node) {
+    analyzer.visit(node);
+    if (!node->resolved_symbol->dataType) throw std::runtime_error("Variable not found or unresolved.");
+    return node->resolved_symbol->dataType;
+}
+
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(BinaryOperationExpressionNode* node) {
+    analyzer.visit(node);
+    if (!node->resolved_type) throw std::runtime_error("Binary op failed type resolution");
+    return node->resolved_type;
+}
 
-    throw std::runtime_error("Semantic Error: Expression resolution returned null.");
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(FunctionCallNode* node) {
+    analyzer.visit(node);
+    return node->resolved_type;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visitIntegerLiteralExpression(IntegerLiteralExpressionNode* node) {
-    node->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_INT);
-    return node->resolved_type->clone();
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(MemberAccessNode* node) {
+    analyzer.visit(node);
+    return node->resolved_type;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visitStringLiteralExpression(StringLiteralExpressionNode* node) {
-    node->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_STRING);
-    return node->resolved_type->clone();
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(UnaryOpExpressionNode* node) {
+    analyzer.visit(node);
+    if (!node->resolved_type) throw std::runtime_error("Unary op failed type resolution");
+    return node->resolved_type;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visitBooleanLiteralExpression(BooleanLiteralExpressionNode* node) {
-    node->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_BOOL);
-    return node->resolved_type->clone();
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(ArrayAccessNode* node) {
+    analyzer.visit(node);
+    const TypeNode* array_type = analyzer.visitExpression(node->array_expr.get());
+    return static_cast<const ArrayTypeNode*>(array_type)->base_type;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visitCharacterLiteralExpression(CharacterLiteralExpressionNode* node) {
-    node->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_CHAR);
-    return node->resolved_type->clone();
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(VariableAssignmentNode* node) {
+    analyzer.visit(node);
+    return analyzer.visitExpression(node->left.get());
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visitFloatLiteralExpression(FloatLiteralExpressionNode* node) {
-    node->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_FLOAT);
-    return node->resolved_type->clone();
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(VariableDeclarationNode* node) {
+    analyzer.visit(node);
+    return node->type;
 }
 
-std::unique_ptr<TypeNode> SemanticAnalyzer::visitDoubleLiteralExpression(DoubleLiteralExpressionNode* node) {
-    node->resolved_type = std::make_unique<PrimitiveTypeNode>(Token::KEYWORD_DOUBLE);
-    return node->resolved_type->clone();
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(ScopeResolutionNode* node) {
+    analyzer.visit(node);
+    if (!node->resolved_type) {
+        throw std::runtime_error("Semantic Error: Could not resolve type for namespace member.");
+    }
+    return node->resolved_type;
 }
 
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::notAnExpression(ASTNode* node) {
+    throw std::runtime_error(std::string("Semantic Error: Expected an expression, got ") + nodeTypeName(node->node_type) + ".");
+}
+
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(ProgramNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(FunctionDefinitionNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(PrintStatementNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(ReturnStatementNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(IfStatementNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(WhileStatementNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(ForStatementNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(StructDefinitionNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(NamespaceDefinition* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(AsmStatementNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(ConstantDeclarationNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(EnumStatementNode* node) { notAnExpression(node); }
+const TypeNode* SemanticAnalyzer::ExpressionVisitor::visit(SwitchStatementNode* node) { notAnExpression(node); }
+
 std::string SemanticAnalyzer::typeToString(const TypeNode* type) {
     if (!type) return "null";
     switch (type->category) {
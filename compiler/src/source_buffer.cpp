@@ -0,0 +1,51 @@
+#include "source_buffer.hpp"
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+SourceBuffer::~SourceBuffer() {
+    release();
+}
+
+void SourceBuffer::release() {
+    if (mapped && data) munmap(const_cast<char*>(data), length);
+    data = nullptr;
+    length = 0;
+    mapped = false;
+    fallback.clear();
+}
+
+bool SourceBuffer::open(const std::string& path) {
+    release();
+    filepath = path;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            madvise(addr, st.st_size, MADV_SEQUENTIAL); // The lexer reads front to back
+            data = static_cast<const char*>(addr);
+            length = st.st_size;
+            mapped = true;
+            ::close(fd);
+            return true;
+        }
+    }
+    ::close(fd);
+
+    // Not mappable (empty file, pipe, ...), read it the old way
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    fallback = buffer.str();
+    data = fallback.data();
+    length = fallback.size();
+    return true;
+}
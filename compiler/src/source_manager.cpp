@@ -0,0 +1,33 @@
+#include "source_manager.hpp"
+
+SourceManager& SourceManager::global() {
+    static SourceManager instance;
+    return instance;
+}
+
+void SourceManager::setUnit(std::string unit_path, std::string_view unit_text) {
+    path = std::move(unit_path);
+    text = unit_text;
+    lines.reset();
+}
+
+const LineTable& SourceManager::lineTable() {
+    if (!lines) {
+        Lexer lexer(text);
+        while (lexer.next().kind != Token::END_OF_FILE) {}
+        lines = lexer.takeLineTable();
+    }
+    return *lines;
+}
+
+PresumedLoc SourceManager::presumed(SourceLoc loc) {
+    if (loc == NO_LOC || loc > text.size()) return {path, 0, 0};
+    const LineTable& table = lineTable();
+    std::string_view file = table.file(loc);
+    return {file.empty() ? std::string_view(path) : file, table.line(loc), table.column(loc)};
+}
+
+std::string SourceManager::describe(SourceLoc loc) {
+    PresumedLoc where = presumed(loc);
+    return std::string(where.file) + ":" + std::to_string(where.line) + ":" + std::to_string(where.column);
+}
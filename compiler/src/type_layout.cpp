@@ -0,0 +1,93 @@
+#include "type_layout.hpp"
+#include "ast.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+LayoutTable& LayoutTable::global() {
+    static LayoutTable instance;
+    return instance;
+}
+
+const TypeLayout& LayoutTable::layout(const TypeNode* type) {
+    if (!type) {
+        throw std::runtime_error("Semantic Error: Attempted to get size of a null type.");
+    }
+    if (type->id >= layouts.size()) layouts.resize(type->id + 1);
+    if (layouts[type->id].align == 0) {
+        TypeLayout computed = compute(type); // May recurse and grow the table
+        layouts[type->id] = computed;
+    }
+    return layouts[type->id];
+}
+
+TypeLayout LayoutTable::compute(const TypeNode* type) {
+    switch (type->category) {
+        case TypeNode::TypeCategory::PRIMITIVE: {
+            const PrimitiveTypeNode* prim_type = static_cast<const PrimitiveTypeNode*>(type);
+            switch (prim_type->primitive_type) {
+                case Token::KEYWORD_INT: return {4, 4}; // 4 bytes for int (dword)
+                case Token::KEYWORD_FLOAT: return {4, 4}; // 4 bytes for float (dword)
+                case Token::KEYWORD_DOUBLE: return {8, 8}; // 8 bytes for double (qword)
+                case Token::KEYWORD_BOOL: return {1, 1}; // 1 byte for bool
+                case Token::KEYWORD_CHAR: return {1, 1}; // 1 byte for char
+                case Token::KEYWORD_STRING: return {8, 8}; // 8 bytes for string (pointer)
+                case Token::KEYWORD_VOID: return {0, 1}; // Void has no size
+                default: throw std::runtime_error("Semantic Error: Unknown primitive type (" + std::to_string(static_cast<int>(prim_type->primitive_type)) + ") for size calculation.");
+            }
+        }
+        case TypeNode::TypeCategory::POINTER:
+            return {8, 8}; // Pointers are 8 bytes on x64
+        case TypeNode::TypeCategory::ARRAY: {
+            const ArrayTypeNode* array_type = static_cast<const ArrayTypeNode*>(type);
+            if (array_type->size <= 0) {
+                throw std::runtime_error("Semantic Error: Unsized arrays not allowed for local variables.");
+            }
+            TypeLayout element = layout(array_type->base_type);
+            return {element.size * array_type->size, element.align};
+        }
+        case TypeNode::TypeCategory::STRUCT: {
+            const StructTypeNode* struct_type = static_cast<const StructTypeNode*>(type);
+            if (!struct_type->definition) {
+                throw std::runtime_error("Semantic Error: Undefined struct '" + struct_type->struct_name + "'.");
+            }
+            return {struct_type->definition->size, struct_type->definition->align};
+        }
+        default:
+            throw std::runtime_error("Semantic Error: Unknown type category for size calculation.");
+    }
+}
+
+void LayoutTable::layoutStruct(StructDefinitionNode& definition) {
+    // Placement order: declaration order, or by decreasing alignment for `reorder`. The
+    // sort is stable, so members that align alike keep their relative order. Only the
+    // offsets follow this order, the members themselves stay as declared.
+    std::vector<StructMember*> order;
+    for (auto& member : definition.members) order.push_back(&member);
+    if (definition.reorder) {
+        std::stable_sort(order.begin(), order.end(), [&](const StructMember* a, const StructMember* b) {
+            return alignOf(a->type) > alignOf(b->type);
+        });
+    }
+
+    int offset = 0;
+    int align = 1;
+    for (StructMember* member : order) {
+        TypeLayout member_layout = layout(member->type);
+        int member_align = definition.packed ? 1 : member_layout.align;
+        offset = alignUp(offset, member_align);
+        member->offset = offset;
+        offset += member_layout.size;
+        align = std::max(align, member_align);
+    }
+
+    // align(N) only ever raises the alignment, packed is the way to lower it
+    align = std::max(align, definition.explicit_align);
+    definition.size = alignUp(offset, align); // Tail padding, so array elements stay aligned
+    definition.align = align;
+
+    // A struct defined again changes the layout of everything built from it
+    const StructTypeNode* type = structType(definition.name);
+    if (type->definition && type->definition != &definition) layouts.clear();
+    type->definition = &definition;
+}
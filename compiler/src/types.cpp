@@ -0,0 +1,35 @@
+#include "types.hpp"
+
+TypeContext& TypeContext::global() {
+    static TypeContext instance;
+    return instance;
+}
+
+TypeContext::TypeContext() {
+    auto_type = make<AutoTypeNode>();
+    for (size_t type = 0; type < primitives.size(); ++type) {
+        primitives[type] = make<PrimitiveTypeNode>(static_cast<Token::Type>(type));
+    }
+}
+
+const PointerTypeNode* TypeContext::pointerTo(const TypeNode* base) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pointers.find(base);
+    if (it != pointers.end()) return it->second;
+    return pointers[base] = make<PointerTypeNode>(base);
+}
+
+const ArrayTypeNode* TypeContext::arrayOf(const TypeNode* base, int size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto key = std::make_pair(base, size);
+    auto it = arrays.find(key);
+    if (it != arrays.end()) return it->second;
+    return arrays[key] = make<ArrayTypeNode>(base, size);
+}
+
+const StructTypeNode* TypeContext::structNamed(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = structs.find(name);
+    if (it != structs.end()) return it->second;
+    return structs[name] = make<StructTypeNode>(name);
+}
@@ -0,0 +1,654 @@
+// Regression checks, run by ctest (see CMakeLists.txt). Usage:
+//   nytro-tests <check> [nytro-c path] [tests directory] [scratch directory]
+// Checks on the front end run in-process, the ones about whole compiles run the
+// nytro-c binary on programs from the repository's tests/ directory.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast_cache.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "semantic_analyzer.hpp"
+#include "source_manager.hpp"
+#include "symbol_table.hpp"
+
+namespace {
+
+int g_failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << std::endl;
+        g_failures++;
+    }
+}
+
+struct Paths {
+    std::string compiler; // nytro-c
+    std::string tests;    // The repository's tests/ directory
+    std::string scratch;  // Where outputs and copied inputs go
+};
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Could not read " + path);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out || !(out << text)) throw std::runtime_error("Could not write " + path);
+}
+
+std::vector<std::string> lines(const std::string& text) {
+    std::vector<std::string> result;
+    std::istringstream in(text);
+    for (std::string line; std::getline(in, line);) result.push_back(line);
+    return result;
+}
+
+std::string trim(const std::string& s) {
+    size_t first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    return s.substr(first, s.find_last_not_of(" \t\r") - first + 1);
+}
+
+// Runs nytro-c on <scratch>/<name>, written with `source`. Returns the exit status,
+// the compiler's output goes to <scratch>/<name>.log
+int runCompiler(const Paths& paths, const std::string& name, const std::string& source, const std::string& flags) {
+    std::string input = paths.scratch + "/" + name;
+    std::string output = input + ".asm";
+    writeFile(input, source);
+    std::remove(output.c_str());
+    std::string command = "\"" + paths.compiler + "\" \"" + input + "\" \"" + output + "\" " + flags + " > \"" + input + ".log\" 2>&1";
+    return std::system(command.c_str());
+}
+
+// Compiles tests/<program> from a copy in the scratch directory, so no cache file lands
+// next to the original. Returns the assembly, throws if the compiler fails.
+std::string compile(const Paths& paths, const std::string& program, const std::string& flags = "-no-ast-cache") {
+    std::string input = paths.scratch + "/" + program;
+    if (runCompiler(paths, program, readFile(paths.tests + "/" + program), flags) != 0) {
+        throw std::runtime_error("nytro-c failed on " + program + ":\n" + readFile(input + ".log"));
+    }
+    return readFile(input + ".asm");
+}
+
+std::unique_ptr<ProgramNode> parseSource(std::string_view source) {
+    return Parser(Lexer(source)).parse();
+}
+
+// `return a + a + ... + a;` with `terms` operands, a left-leaning chain that deep
+std::string deepChain(int terms) {
+    std::string source = "int f(int a) { return a";
+    for (int i = 1; i < terms; ++i) source += " + a";
+    return source + "; }";
+}
+
+// Every `// expect-asm: <line>` comment in the program, indented or not, has to be a
+// line of its assembly
+void checkExpectedAssembly(const Paths& paths, const std::string& program) {
+    std::string assembly = compile(paths, program);
+    std::vector<std::string> asm_lines = lines(assembly);
+    int expectations = 0;
+    for (const std::string& raw : lines(readFile(paths.tests + "/" + program))) {
+        std::string line = trim(raw);
+        static const std::string marker = "// expect-asm:";
+        if (line.compare(0, marker.size(), marker) != 0) continue;
+        std::string expected = trim(line.substr(marker.size()));
+        expectations++;
+        bool found = false;
+        for (const std::string& asm_line : asm_lines) found = found || trim(asm_line) == expected;
+        check(found, program + ": assembly has '" + expected + "'");
+    }
+    check(expectations > 0, program + " has expect-asm lines");
+}
+
+// Every TOKEN_LIST entry spelled like a keyword must come back from the lexer as that
+// keyword, and a longer word starting with it as an identifier
+void checkKeywords(const Paths&) {
+    struct Entry { const char* text; Token::Type type; };
+    static const Entry entries[] = {
+#define AS_ENTRY(name, str) {str, Token::name},
+        TOKEN_LIST(AS_ENTRY)
+#undef AS_ENTRY
+    };
+
+    int keywords = 0;
+    for (const Entry& entry : entries) {
+        std::string_view text = entry.text;
+        bool is_keyword = !text.empty();
+        for (char c : text) is_keyword = is_keyword && c >= 'a' && c <= 'z';
+        if (!is_keyword) continue;
+        keywords++;
+
+        Lexer exact(text);
+        check(exact.next().kind == entry.type, "'" + std::string(text) + "' is lexed as its keyword");
+        std::string longer = std::string(text) + "x";
+        Lexer identifier(longer);
+        check(identifier.next().kind == Token::IDENTIFIER, "'" + longer + "' is lexed as an identifier");
+    }
+    check(keywords > 20, "TOKEN_LIST has keywords");
+}
+
+// A source big enough to be split into several chunks, with every token kind, numbers
+// that need the double pool and #line markers so the line tables have to be merged
+std::string largeSource() {
+    std::string source;
+    for (int i = 0; source.size() < 4 * MIN_LEX_CHUNK; ++i) {
+        if (i % 500 == 0) source += "#line " + std::to_string(i + 1) + " \"part" + std::to_string(i / 500) + ".ny\"\n";
+        std::string n = std::to_string(i);
+        source += "int f" + n + "(int a, char c) {\n"
+                  "    double d = " + n + ".25; float x = 1.5f; int h = 0x1F_FF + 0b101;\n"
+                  "    string s = \"text " + n + "\"; // comment " + n + "\n"
+                  "    if (a <= " + n + ") { if (c != 'q') { return a * 2 - h / 3; } }\n"
+                  "    s = ns::value" + n + ";\n"
+                  "}\n";
+    }
+    return source;
+}
+
+// The parallel lexer must produce exactly the serial token stream: kinds, positions,
+// identifiers, decoded numbers and the line each token is on
+void checkParallelLexing(const Paths&) {
+    std::string source = largeSource();
+    TokenBuffer serial = tokenize(source, 1);
+    TokenBuffer parallel = tokenize(source, 4);
+
+    check(serial.size() == parallel.size(), "same number of tokens");
+    for (size_t i = 0; i < serial.size() && i < parallel.size() && g_failures < 10; ++i) {
+        Token a = serial[i];
+        Token b = parallel[i];
+        std::string at = " of token " + std::to_string(i) + " ('" + a.text() + "')";
+        check(a.type == b.type, "type" + at);
+        check(a.offset == b.offset && a.value == b.value, "position" + at);
+        check(a.ident == b.ident, "identifier" + at);
+        if (a.type == Token::DOUBLE_LITERAL) check(a.number.double_value == b.number.double_value, "value" + at);
+        else check(a.number.bits == b.number.bits, "value" + at);
+        check(a.line() == b.line() && a.column() == b.column() && a.lines->file(a.offset) == b.lines->file(b.offset),
+              "line" + at);
+    }
+}
+
+// Every node of a tree in pre-order, as its kind and name and where it starts
+std::vector<std::string> preOrder(ASTNode* root) {
+    std::vector<std::string> nodes;
+    walkPreOrder(root, [&nodes](ASTNode* node) { nodes.push_back(node->type_name() + " at " + std::to_string(node->loc)); });
+    return nodes;
+}
+
+// The message a parse with that many threads fails with, empty if it doesn't
+std::string parseError(std::string_view source, unsigned threads) {
+    try {
+        Parser(tokenize(source, 1), threads).parse();
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+// Function bodies parsed on several threads must give the serial tree node for node.
+// A body a worker fails on sends the unit back to the serial parser, which reports the
+// error exactly as a serial run does.
+void checkParallelParsing(const Paths&) {
+    std::string source = largeSource();
+    std::unique_ptr<ProgramNode> serial = Parser(tokenize(source, 1), 1).parse();
+    std::unique_ptr<ProgramNode> parallel = Parser(tokenize(source, 1), 4).parse();
+    check(!parallel->worker_arenas.empty(), "the bodies were parsed on workers");
+    std::vector<std::string> expected = preOrder(serial.get());
+    std::vector<std::string> actual = preOrder(parallel.get());
+    auto mismatch = std::mismatch(expected.begin(), expected.end(), actual.begin(), actual.end());
+    check(mismatch.first == expected.end() && mismatch.second == actual.end(),
+          "parallel parse matches the serial one, first difference at node " +
+          std::to_string(mismatch.first - expected.begin()) + " of " + std::to_string(expected.size()));
+
+    // The serial pass skips the bodies, so only a worker sees this one's error
+    std::string broken = source + "int broken(int a) {\n    return a + ;\n}\n" + source;
+    std::string serial_error = parseError(broken, 1);
+    check(!serial_error.empty(), "a broken body fails the serial parse");
+    check(parseError(broken, 4) == serial_error, "the parallel parse fails the same way, got: " + parseError(broken, 4));
+}
+
+// A token as the scan check expects it
+struct TokenAt {
+    Token::Type type;
+    uint32_t offset;
+    uint32_t length;
+    int line;
+    bool operator==(const TokenAt& other) const {
+        return type == other.type && offset == other.offset && length == other.length && line == other.line;
+    }
+};
+
+// `count` bytes cycling through `alphabet`
+std::string run(std::string_view alphabet, size_t count) {
+    std::string text;
+    for (size_t i = 0; i < count; ++i) text += alphabet[i % alphabet.size()];
+    return text;
+}
+
+// Lexes `source` and compares every token, END_OF_FILE included, with `expected`
+void checkTokens(const std::string& what, const std::string& source, const std::vector<TokenAt>& expected) {
+    Lexer lexer(source);
+    std::vector<TokenAt> actual;
+    for (RawToken raw = lexer.next(); actual.size() <= expected.size(); raw = lexer.next()) {
+        actual.push_back({raw.kind, raw.offset, raw.length, lexer.view(raw).line()});
+        if (raw.kind == Token::END_OF_FILE) break;
+    }
+    check(actual == expected && lexer.errorCount() == 0, what);
+}
+
+// The scan kernels take 16 or 32 bytes at a time and finish with a plain loop. Runs of
+// whitespace, identifier, string and comment bytes ending at every offset over two
+// blocks, once followed by more source and once ending the input mid-block, have to
+// give the same token positions and line starts as a byte-at-a-time lexer would.
+void checkScanKernels(const Paths&) {
+    // Odd lengths, so across the runs every byte of each kind (newlines above all) lands
+    // on every position of a block
+    const std::string_view spaces = " \t\n\r\v\n\f";
+    const std::string_view word = "a_Z9bY0";
+    const std::string_view text = "ab \n'c\t";
+    const std::string_view comment = "x /\t\"y*";
+    auto lines = [](const std::string& s) { return 1 + static_cast<int>(std::count(s.begin(), s.end(), '\n')); };
+
+    for (uint32_t n = 0; n <= 64; ++n) {
+        std::string at = " of " + std::to_string(n);
+
+        std::string ws = run(spaces, n);
+        int after = lines(ws);
+        checkTokens("whitespace run" + at, "a" + ws + ";",
+                    {{Token::IDENTIFIER, 0, 1, 1}, {Token::SEMICOLON, 1 + n, 1, after}, {Token::END_OF_FILE, 2 + n, 0, after}});
+        checkTokens("whitespace at the end" + at, "a" + ws,
+                    {{Token::IDENTIFIER, 0, 1, 1}, {Token::END_OF_FILE, 1 + n, 0, after}});
+
+        if (n > 0) {
+            std::string id = run(word, n);
+            checkTokens("identifier" + at, id + ";",
+                        {{Token::IDENTIFIER, 0, n, 1}, {Token::SEMICOLON, n, 1, 1}, {Token::END_OF_FILE, n + 1, 0, 1}});
+            checkTokens("identifier at the end" + at, id, {{Token::IDENTIFIER, 0, n, 1}, {Token::END_OF_FILE, n, 0, 1}});
+        }
+
+        std::string body = run(text, n);
+        int string_end = lines(body);
+        checkTokens("string" + at, "\"" + body + "\";",
+                    {{Token::STRING_LITERAL, 0, n + 2, 1}, {Token::SEMICOLON, n + 2, 1, string_end},
+                     {Token::END_OF_FILE, n + 3, 0, string_end}});
+        checkTokens("string at the end" + at, "\"" + body + "\"",
+                    {{Token::STRING_LITERAL, 0, n + 2, 1}, {Token::END_OF_FILE, n + 2, 0, string_end}});
+
+        std::string note = "//" + run(comment, n);
+        uint32_t length = static_cast<uint32_t>(note.size());
+        checkTokens("comment" + at, note + "\nb", {{Token::IDENTIFIER, length + 1, 1, 2}, {Token::END_OF_FILE, length + 2, 0, 2}});
+        checkTokens("comment at the end" + at, note, {{Token::END_OF_FILE, length, 0, 1}});
+    }
+}
+
+// #line markers as the preprocessor writes them, with '"' and backslashes in the path
+// escaped; the lexer has to hand back the path as it was
+void checkLineMarkers(const Paths&) {
+    Lexer lexer("#line 7 \"dir\\\\sub\\\"q\\\".ny\"\nint x;\n#line 3 \"plain.ny\"\nint y;\n");
+    Token x = lexer.view(lexer.next());
+    check(x.type == Token::KEYWORD_INT && x.line() == 7, "first marker sets the line");
+    check(x.lines->file(x.offset) == "dir\\sub\"q\".ny", "escapes are taken out of the path");
+    lexer.next();
+    lexer.next();
+    Token y = lexer.view(lexer.next());
+    check(y.line() == 3 && y.lines->file(y.offset) == "plain.ny", "a path without escapes");
+}
+
+// Literal decoding: hex, binary and '_' separators, the f suffix with and without a
+// fraction, and doubles from the pool; then the exact bit patterns in .data
+void checkLiterals(const Paths& paths) {
+    Lexer lexer("0x1F_FF 0b101 1_000 0xFFFFFFFF 5f 3.14159f 0.5");
+    auto bits = [](float value) { uint32_t b; std::memcpy(&b, &value, sizeof(b)); return b; };
+
+    Token hex = lexer.view(lexer.next());
+    check(hex.type == Token::INTEGER_LITERAL && hex.number.bits == 0x1FFF, "0x1F_FF");
+    Token binary = lexer.view(lexer.next());
+    check(binary.type == Token::INTEGER_LITERAL && binary.number.bits == 5, "0b101");
+    Token separated = lexer.view(lexer.next());
+    check(separated.type == Token::INTEGER_LITERAL && separated.number.bits == 1000, "1_000");
+    Token pattern = lexer.view(lexer.next());
+    check(pattern.type == Token::INTEGER_LITERAL && pattern.number.bits == 0xFFFFFFFFu, "0xFFFFFFFF");
+    Token five = lexer.view(lexer.next());
+    check(five.type == Token::FLOAT_LITERAL && five.number.bits == bits(5.0f), "5f");
+    Token pi = lexer.view(lexer.next());
+    check(pi.type == Token::FLOAT_LITERAL && pi.number.bits == 0x40490fd0u, "3.14159f");
+    Token half = lexer.view(lexer.next());
+    check(half.type == Token::DOUBLE_LITERAL && half.number.double_value == 0.5, "0.5");
+    check(lexer.errorCount() == 0, "well-formed literals lex without errors");
+
+    // Each of these is one literal and exactly one error, and reads as 0
+    for (const char* bad : {"1__0", "1_", "0x_FF", "0xFF_", "0b1__0", "1_.5", "1._5", "5_f", "99999999999", "0b102"}) {
+        Lexer bad_lexer(bad);
+        Token token = bad_lexer.view(bad_lexer.next());
+        check(token.value == bad && token.number.bits == 0, std::string(bad) + " lexes as one literal of value 0");
+        check(bad_lexer.errorCount() == 1, std::string(bad) + " is reported once");
+    }
+
+    // A lexer error fails the compile, -stream included
+    for (const std::string flags : {"-no-ast-cache", "-no-ast-cache -stream"}) {
+        int status = runCompiler(paths, "bad_literal.ny", "int x = 1__0;\nint main() { return x; }\n", flags);
+        std::string log = readFile(paths.scratch + "/bad_literal.ny.log");
+        check(status != 0, "nytro-c " + flags + " fails on a lexer error");
+        check(log.find("Misplaced '_'") != std::string::npos, "nytro-c " + flags + " reports the misplaced '_'");
+    }
+
+    checkExpectedAssembly(paths, "test_literals.ny");
+}
+
+// A compile that loads the AST from the cache must give the same assembly as the one
+// that parsed the source and wrote the cache
+void checkASTCache(const Paths& paths) {
+    const std::string program = "test_structs_comprehensive.nyt";
+    std::string cache = paths.scratch + "/" + program + ".astc";
+    std::remove(cache.c_str());
+
+    std::string parsed = compile(paths, program, "-verbose");
+    std::string first_log = readFile(paths.scratch + "/" + program + ".log");
+    check(first_log.find("Loaded AST from cache") == std::string::npos, "first compile parses the source");
+    check(std::ifstream(cache).good(), "first compile writes " + cache);
+
+    std::string loaded = compile(paths, program, "-verbose");
+    std::string second_log = readFile(paths.scratch + "/" + program + ".log");
+    check(second_log.find("Loaded AST from cache") != std::string::npos, "second compile loads the cache");
+    check(parsed == loaded, "assembly from the cached AST is identical");
+
+    // A cache hit skips the lexer and parser, and with them their diagnostics. A source
+    // that got any isn't cached, so every compile reports them.
+    const std::string noisy = "cache_diagnostics.ny";
+    std::string noisy_cache = paths.scratch + "/" + noisy + ".astc";
+    std::remove(noisy_cache.c_str());
+    for (int run = 1; run <= 2; ++run) {
+        runCompiler(paths, noisy, "int x = 99999999999;\nint main() { return x; }\n", "");
+        std::string log = readFile(paths.scratch + "/" + noisy + ".log");
+        check(log.find("Integer literal out of range") != std::string::npos,
+              "compile " + std::to_string(run) + " reports the literal out of range");
+    }
+    check(!std::ifstream(noisy_cache).good(), "no cache for a source with diagnostics");
+
+    // A chain far deeper than the native stack writes and loads back node for node
+    auto deep_ast = parseSource(deepChain(300000));
+    std::string deep_cache = paths.scratch + "/deep_chain.astc";
+    check(writeASTCache(deep_cache, *deep_ast, 1), "deep chain: cache written");
+    std::unique_ptr<ProgramNode> deep_loaded = loadASTCache(deep_cache, 1);
+    check(deep_loaded != nullptr, "deep chain: cache loaded");
+    if (deep_loaded) {
+        std::vector<ASTNode::NodeType> written, read;
+        walkPreOrder(deep_ast.get(), [&written](ASTNode* node) { written.push_back(node->node_type); });
+        walkPreOrder(deep_loaded.get(), [&read](ASTNode* node) { read.push_back(node->node_type); });
+        check(written == read, "deep chain: loaded tree matches the parsed one");
+    }
+    std::remove(deep_cache.c_str());
+}
+
+// Pre- and post-order visit children in source order, false from a pre-order visitor
+// skips the children, and a chain far deeper than the native stack walks fine
+void checkWalkers(const Paths&) {
+    auto ast = parseSource("int f() { return 1 + 2 * 3; }");
+    std::string pre, post, skipped;
+    walkPreOrder(ast.get(), [&pre](ASTNode* node) { pre += std::string(nodeTypeName(node->node_type)) + " "; });
+    walkPostOrder(ast.get(), [&post](ASTNode* node) { post += std::string(nodeTypeName(node->node_type)) + " "; });
+    walkPreOrder(ast.get(), [&skipped](ASTNode* node) {
+        skipped += std::string(nodeTypeName(node->node_type)) + " ";
+        return node->node_type != ASTNode::NodeType::BINARY_OPERATION_EXPRESSION;
+    });
+    check(pre == "PROGRAM FUNCTION_DEFINITION RETURN_STATEMENT BINARY_OPERATION INTEGER_LITERAL "
+                 "BINARY_OPERATION INTEGER_LITERAL INTEGER_LITERAL ", "pre-order, got " + pre);
+    check(post == "INTEGER_LITERAL INTEGER_LITERAL INTEGER_LITERAL BINARY_OPERATION BINARY_OPERATION "
+                  "RETURN_STATEMENT FUNCTION_DEFINITION PROGRAM ", "post-order, got " + post);
+    check(skipped == "PROGRAM FUNCTION_DEFINITION RETURN_STATEMENT BINARY_OPERATION ", "pre-order skip, got " + skipped);
+
+    const int terms = 300000;
+    auto deep_ast = parseSource(deepChain(terms));
+    size_t pre_count = 0, post_count = 0;
+    walkPreOrder(deep_ast.get(), [&pre_count](ASTNode*) { pre_count++; });
+    walkPostOrder(deep_ast.get(), [&post_count](ASTNode*) { post_count++; });
+    size_t expected = 2 * terms - 1 + 3; // Operands and operators, the return, the function, the program
+    check(pre_count == expected && post_count == expected, "deep chain: " + std::to_string(pre_count) + " and " +
+          std::to_string(post_count) + " nodes, expected " + std::to_string(expected));
+}
+
+// A semantic error points at the innermost node that has a position, inside an
+// expression too, not at the statement holding it
+void checkErrorLocations(const Paths&) {
+    const std::pair<std::string, std::string> cases[] = {
+        {"int main() {\n    y = 2;\n    return 0;\n}\n", "locations.ny:2:5"},
+        {"int main() {\n    int x = 1 + (2 * z);\n    return x;\n}\n", "locations.ny:2:22"},
+        {"int f(int a) { return a; }\nint main() {\n    return f(1 + w);\n}\n", "locations.ny:3:18"},
+    };
+    for (const auto& [source, where] : cases) {
+        SourceManager::global().setUnit("locations.ny", source);
+        std::string message;
+        try {
+            auto ast = parseSource(source);
+            SymbolTable symbol_table;
+            SemanticAnalyzer analyzer(ast, symbol_table);
+            analyzer.analyze();
+        } catch (const std::runtime_error& e) {
+            message = e.what();
+        }
+        check(message.find(" at " + where) != std::string::npos, "error at " + where + ", got: " + message);
+    }
+}
+
+// An expression as an s-expression: "(- (- a b) c)", "(. s m)", "([] p 1)", "(call f x)"
+std::string shape(const ASTNode* node) {
+    static const char* spellings[] = {
+#define AS_SPELLING(name, str) str,
+        TOKEN_LIST(AS_SPELLING)
+#undef AS_SPELLING
+    };
+    switch (node->node_type) {
+        case ASTNode::NodeType::BINARY_OPERATION_EXPRESSION: {
+            auto* b = static_cast<const BinaryOperationExpressionNode*>(node);
+            return std::string("(") + spellings[b->op_type] + " " + shape(b->left.get()) + " " + shape(b->right.get()) + ")";
+        }
+        case ASTNode::NodeType::UNARY_OP_EXPRESSION: {
+            auto* u = static_cast<const UnaryOpExpressionNode*>(node);
+            return std::string("(") + spellings[u->op_type] + " " + shape(u->operand.get()) + ")";
+        }
+        case ASTNode::NodeType::VARIABLE_ASSIGNMENT: {
+            auto* a = static_cast<const VariableAssignmentNode*>(node);
+            return "(= " + shape(a->left.get()) + " " + shape(a->right.get()) + ")";
+        }
+        case ASTNode::NodeType::ARRAY_ACCESS_EXPRESSION: {
+            auto* a = static_cast<const ArrayAccessNode*>(node);
+            return "([] " + shape(a->array_expr.get()) + " " + shape(a->index_expr.get()) + ")";
+        }
+        case ASTNode::NodeType::MEMBER_ACCESS_EXPRESSION: {
+            auto* m = static_cast<const MemberAccessNode*>(node);
+            return "(. " + shape(m->struct_expr.get()) + " " + spelling(m->member_name) + ")";
+        }
+        case ASTNode::NodeType::FUNCTION_CALL: {
+            auto* c = static_cast<const FunctionCallNode*>(node);
+            std::string result = "(call " + spelling(c->function_name);
+            for (auto& argument : c->arguments) result += " " + shape(argument.get());
+            return result + ")";
+        }
+        case ASTNode::NodeType::VARIABLE_REFERENCE:
+            return spelling(static_cast<const VariableReferenceNode*>(node)->name);
+        case ASTNode::NodeType::INTEGER_LITERAL_EXPRESSION:
+            return std::to_string(static_cast<const IntegerLiteralExpressionNode*>(node)->value);
+        default:
+            return nodeTypeName(node->node_type);
+    }
+}
+
+// Binary operators are left associative at every level, bind by precedence (* / over
+// + - over comparisons), and prefix operators apply to the whole postfix chain after them
+void checkPrecedence(const Paths&) {
+    const std::pair<const char*, const char*> cases[] = {
+        {"a - b - c", "(- (- a b) c)"},
+        {"a / b / c", "(/ (/ a b) c)"},
+        {"a + b * c", "(+ a (* b c))"},
+        {"a * b + c", "(+ (* a b) c)"},
+        {"a - b * c - d", "(- (- a (* b c)) d)"},
+        {"(a + b) * c", "(* (+ a b) c)"},
+        {"a - (b - c)", "(- a (- b c))"},
+        {"a < b < c", "(< (< a b) c)"},
+        {"a == b < c", "(< (== a b) c)"},
+        {"a + b < c * d", "(< (+ a b) (* c d))"},
+        {"a < b + c == d", "(== (< a (+ b c)) d)"},
+        {"*p[1]", "(* ([] p 1))"},
+        {"&s.m", "(& (. s m))"},
+        {"*s.p.q", "(* (. (. s p) q))"},
+        {"!f(x)", "(! (call f x))"},
+        {"!!*p", "(! (! (* p)))"},
+        {"*p * *q", "(* (* p) (* q))"},
+        {"f(a + b, c * d)", "(call f (+ a b) (* c d))"},
+        {"a = b = c + d", "(= a (= b (+ c d)))"},
+    };
+    for (const auto& [expression, expected] : cases) {
+        auto ast = parseSource(std::string("int f() { return ") + expression + "; }");
+        auto* ret = static_cast<const ReturnStatementNode*>(ast->functions[0]->body_statements[0].get());
+        std::string actual = shape(ret->expression.get());
+        check(actual == expected, std::string(expression) + " parses as " + expected + ", got " + actual);
+    }
+}
+
+// Every `// expect-layout: <struct> size <n> align <n> <member> <offset>...` in the
+// program has to match the struct as the analyzer laid it out; then the alignment of
+// the variables in .data, from its expect-asm lines
+void checkLayout(const Paths& paths) {
+    const std::string program = "test_struct_layout.ny";
+    std::string source = readFile(paths.tests + "/" + program);
+    SourceManager::global().setUnit(program, source);
+    std::unique_ptr<ProgramNode> ast = parseSource(source);
+    SymbolTable symbols;
+    SemanticAnalyzer analyzer(ast, symbols);
+    analyzer.setIsEntryPoint(true);
+    analyzer.analyze();
+
+    std::map<std::string, std::string> layouts;
+    for (const auto& s : ast->structs) {
+        std::string layout = "size " + std::to_string(s->size) + " align " + std::to_string(s->align);
+        for (const auto& member : s->members) layout += " " + spelling(member.name) + " " + std::to_string(member.offset);
+        layouts[s->name] = layout;
+    }
+
+    int expectations = 0;
+    for (const std::string& raw : lines(source)) {
+        std::string line = trim(raw);
+        static const std::string marker = "// expect-layout:";
+        if (line.compare(0, marker.size(), marker) != 0) continue;
+        std::string expected = trim(line.substr(marker.size()));
+        std::string name = expected.substr(0, expected.find(' '));
+        expectations++;
+        check(layouts.count(name) && name + " " + layouts[name] == expected,
+              program + ": layout '" + expected + "', got '" + layouts[name] + "'");
+    }
+    check(expectations > 0, program + " has expect-layout lines");
+
+    checkExpectedAssembly(paths, program);
+}
+
+// A struct or array variable's .data entry has to cover the whole variable
+void checkStorage(const Paths& paths) {
+    checkExpectedAssembly(paths, "test_global_storage.ny");
+}
+
+// Assembly split into what has to be in the same order and what only has to be there.
+// Streaming writes .data after every function and `global` next to each function, batch
+// writes both once, so only the code keeps its order. An `align` stays with its datum.
+struct AssemblyParts {
+    std::vector<std::string> code;
+    std::vector<std::string> data;  // Sorted
+    std::vector<std::string> other; // Sorted: externs, globals
+};
+
+AssemblyParts assemblyParts(const std::string& assembly) {
+    AssemblyParts parts;
+    std::string section, pending_align;
+    for (const std::string& raw : lines(assembly)) {
+        std::string line = trim(raw);
+        if (line.empty()) continue;
+        if (line.compare(0, 8, "section ") == 0) {
+            section = line.substr(8);
+        } else if (line.compare(0, 7, "global ") == 0 || section.empty()) {
+            parts.other.push_back(line);
+        } else if (section == ".text") {
+            parts.code.push_back(line);
+        } else if (line.compare(0, 6, "align ") == 0) {
+            pending_align = line + " | ";
+        } else {
+            parts.data.push_back(pending_align + line);
+            pending_align.clear();
+        }
+    }
+    std::sort(parts.data.begin(), parts.data.end());
+    std::sort(parts.other.begin(), parts.other.end());
+    return parts;
+}
+
+// -stream compiles one function at a time but must generate the same program as a batch
+// compile: the same code, frames included, and the same data
+void checkStreaming(const Paths& paths) {
+    for (const std::string program : {"test_functions.nyt", "test_loops.nyt", "test_structs_comprehensive.nyt",
+                                      "test_floats.ny", "test_namespaces.ny", "test_pointers.nyt"}) {
+        AssemblyParts batch = assemblyParts(compile(paths, program, "-entry -no-ast-cache"));
+        AssemblyParts stream = assemblyParts(compile(paths, program, "-entry -stream -no-ast-cache"));
+        check(!batch.code.empty(), program + " has code");
+        check(batch.code == stream.code, program + ": -stream generates the same code");
+        check(batch.data == stream.data, program + ": -stream generates the same data");
+        check(batch.other == stream.other, program + ": -stream declares the same symbols");
+    }
+
+    // The second pass lexes and parses the source again, only the first one may print
+    const std::string source = "namespace N { int v = 1; print(v); }\nint main() { return N::v; }\n";
+    check(runCompiler(paths, "stream_warning.ny", source, "-entry -stream -no-ast-cache") == 0, "-stream compiles stream_warning.ny");
+    std::string log = readFile(paths.scratch + "/stream_warning.ny.log");
+    size_t warnings = 0;
+    for (size_t pos = log.find("Parser Warning"); pos != std::string::npos; pos = log.find("Parser Warning", pos + 1)) warnings++;
+    check(warnings == 1, "-stream prints the parser warning once, got " + std::to_string(warnings));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    static const std::map<std::string, std::function<void(const Paths&)>> checks = {
+        {"keywords", checkKeywords},
+        {"parallel_lexing", checkParallelLexing},
+        {"parallel_parsing", checkParallelParsing},
+        {"line_markers", checkLineMarkers},
+        {"literals", checkLiterals},
+        {"scan_kernels", checkScanKernels},
+        {"ast_cache", checkASTCache},
+        {"stream", checkStreaming},
+        {"walkers", checkWalkers},
+        {"precedence", checkPrecedence},
+        {"error_locations", checkErrorLocations},
+        {"layout", checkLayout},
+        {"storage", checkStorage},
+    };
+
+    if (argc < 2 || !checks.count(argv[1])) {
+        std::cerr << "Usage: nytro-tests <check> [nytro-c] [tests dir] [scratch dir]\nChecks:";
+        for (const auto& entry : checks) std::cerr << " " << entry.first;
+        std::cerr << std::endl;
+        return 2;
+    }
+    Paths paths{argc > 2 ? argv[2] : "", argc > 3 ? argv[3] : "", argc > 4 ? argv[4] : "."};
+
+    try {
+        checks.at(argv[1])(paths);
+    } catch (const std::exception& e) {
+        std::cerr << "FAIL: " << argv[1] << " threw: " << e.what() << std::endl;
+        return 1;
+    }
+    if (g_failures) std::cerr << g_failures << " check(s) failed" << std::endl;
+    return g_failures ? 1 : 0;
+}